@@ -6,6 +6,12 @@
 #include "socket.hpp"
 #include "json.hpp"
 #include <exception>
+#include <string_view>
+#include <charconv>
+#ifdef __linux__
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+#endif
 
 /// Macro to format and throw errors
 #define THROW_GENERAL_ERROR(MSG) throw std::string(__FILE__":")+std::to_string(__LINE__)+std::string(" in ")+std::string(__func__)+std::string("(): ")+std::string(MSG)
@@ -41,6 +47,70 @@ template<typename ...Args> void sqream::MESSAGES::format(std::vector<char> &outp
     output.pop_back();
 }
 
+static char *frame_header(char *output,uint64_t body_size) ///< <h3>Method to write a JSON PRE_HEADER and little endian body size</h3>
+{
+    /// <b>return</b>(char *):&emsp; where the body starts
+    memcpy(output,sqream::HEADER::HEADER_JSON,sqream::HEADER::SIZE);
+    for(size_t i=0;i<sizeof(uint64_t);i++) output[sqream::HEADER::SIZE+i]=char(body_size>>(8*i));
+    return output+sqream::HEADER::SIZE+sizeof(uint64_t);
+}
+
+std::string_view sqream::MESSAGES::frame_put(char output[PUT_FRAME_SIZE],uint64_t rows) {
+    /// <i>Frame a {"put":rows} message</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li><tt>char output[PUT_FRAME_SIZE]</tt>:&emsp; buffer the frame is written to</li>
+    /// <li><tt>uint64_t rows</tt>:&emsp; rows of the binary message that follows</li>
+    /// </ul>
+    /// <b>return</b>(std::string_view):&emsp; the frame, inside output
+    char *const body=output+HEADER::SIZE+sizeof(uint64_t);
+    char *end=body;
+    constexpr std::string_view head="{\"put\":";
+    end=std::copy(head.begin(),head.end(),end);
+    end=std::to_chars(end,output+PUT_FRAME_SIZE-1,rows).ptr;
+    *end++='}';
+    frame_header(output,end-body);
+    return std::string_view(output,end-output);
+}
+
+std::string_view sqream::MESSAGES::frame_prepare(std::vector<char> &output,const std::string &sql_query,int chunk_size) {
+    /// <i>Frame a {"prepareStatement":sql_query,"chunkSize":chunk_size} message, escaping the query for JSON</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li><tt>std::vector<char> &output</tt>:&emsp; buffer the frame is written to, its capacity is reused</li>
+    /// <li><tt>const std::string &sql_query</tt>:&emsp; SQream SQL query</li>
+    /// <li><tt>int chunk_size</tt>:&emsp; chunk size</li>
+    /// </ul>
+    /// <b>return</b>(std::string_view):&emsp; the frame, inside output
+    static const char hex[]="0123456789abcdef";
+    constexpr std::string_view head="{\"prepareStatement\":\"";
+    constexpr std::string_view tail="\",\"chunkSize\":";
+    const size_t body_at=HEADER::SIZE+sizeof(uint64_t);
+    output.resize(body_at);
+    output.insert(output.end(),head.begin(),head.end());
+    for(const char c:sql_query) {
+        switch(c) {
+            case '"': output.push_back('\\'); output.push_back('"'); break;
+            case '\\': output.push_back('\\'); output.push_back('\\'); break;
+            case '\n': output.push_back('\\'); output.push_back('n'); break;
+            case '\r': output.push_back('\\'); output.push_back('r'); break;
+            case '\t': output.push_back('\\'); output.push_back('t'); break;
+            default:
+                if((unsigned char)c<0x20) {
+                    const char escaped[]={'\\','u','0','0',hex[(unsigned char)c>>4],hex[c&0xf]};
+                    output.insert(output.end(),escaped,escaped+sizeof(escaped));
+                }
+                else output.push_back(c);
+        }
+    }
+    output.insert(output.end(),tail.begin(),tail.end());
+    char number[16];
+    output.insert(output.end(),number,std::to_chars(number,number+sizeof(number),chunk_size).ptr);
+    output.push_back('}');
+    frame_header(output.data(),output.size()-body_at);
+    return std::string_view(output.data(),output.size());
+}
+
 
 /// <i>ERR_HANDLE macro removes redundant code to check the validity of a server response</i><br>
 #define ERR_HANDLE(VALUE,JSON_TYPE)\
@@ -72,24 +142,141 @@ bool verify_response(json& reply_json, std::string value) {
     }
 }
 
+/// <h3>Scanner for the fixed shape replies of hot path messages</h3>
+/// Reads straight from the receive buffer without allocating. Anything it does not recognise, including
+/// error replies, makes it fail so the caller can fall back to a full nlohmann parse.
+struct reply_scanner {
+    const char *p;                                                                                                                  ///< <h3>Next unread character</h3>
+    const char *end;                                                                                                                ///< <h3>End of the reply</h3>
+    reply_scanner(const std::vector<char> &reply) : p(reply.data()), end(reply.data()+reply.size()) {}
+    void ws() { while(p<end and (*p==' ' or *p=='\t' or *p=='\n' or *p=='\r')) p++; }
+    bool lit(char c) { ws(); if(p<end and *p==c) { p++; return true; } return false; }
+    bool str(std::string_view &value) {
+        if(!lit('"')) return false;
+        const char *start=p;
+        while(p<end and *p!='"') if(*p++=='\\') return false;
+        if(p==end) return false;
+        value=std::string_view(start,p++-start);
+        return true;
+    }
+    bool uint(uint64_t &value) {
+        ws();
+        if(p==end or *p<'0' or *p>'9') return false;
+        for(value=0;p<end and *p>='0' and *p<='9';p++) {
+            const uint64_t digit=*p-'0';
+            /// values that do not fit are left to the full parser instead of wrapping
+            if(value>(UINT64_MAX-digit)/10) return false;
+            value=value*10+digit;
+        }
+        return true;
+    }
+    bool done() { ws(); return p==end; }
+};
+
+static bool scan_ack(const std::vector<char> &reply,const std::string_view value) ///< <h3>Method to recognise a {"value":"value"} reply</h3>
+{
+    /// <b>return</b>(bool):&emsp; the reply is exactly the expected acknowledgement
+    reply_scanner scan(reply);
+    std::string_view key,text;
+    return scan.lit('{') and scan.str(key) and key==value and scan.lit(':') and scan.str(text) and text==value and scan.lit('}') and scan.done();
+}
+
+static bool scan_fetch(const std::vector<char> &reply,uint64_t &rows,std::vector<uint64_t> &column_sizes) ///< <h3>Method to read a {"colSzs":[..],"rows":n} reply</h3>
+{
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const std::vector<char> &reply:&emsp; fetch reply as received</li>
+    /// <li>uint64_t &rows:&emsp; rows of the chunk</li>
+    /// <li>std::vector<uint64_t> &column_sizes:&emsp; block sizes of the chunk, its capacity is reused</li>
+    /// </ul>
+    /// <b>return</b>(bool):&emsp; the reply has the expected shape, keys may come in any order
+    reply_scanner scan(reply);
+    std::string_view key;
+    bool has_rows=false,has_sizes=false;
+    column_sizes.clear();
+    if(!scan.lit('{')) return false;
+    do {
+        if(!scan.str(key) or !scan.lit(':')) return false;
+        if(key=="rows" and !has_rows) {
+            if(!scan.uint(rows)) return false;
+            has_rows=true;
+        }
+        else if(key=="colSzs" and !has_sizes) {
+            if(!scan.lit('[')) return false;
+            if(!scan.lit(']')) {
+                do {
+                    uint64_t size;
+                    if(!scan.uint(size)) return false;
+                    column_sizes.push_back(size);
+                } while(scan.lit(','));
+                if(!scan.lit(']')) return false;
+            }
+            has_sizes=true;
+        }
+        else return false;
+    } while(scan.lit(','));
+    return scan.lit('}') and scan.done() and has_rows and has_sizes;
+}
+
+static bool read_fetch(const std::vector<char> &reply,uint64_t &rows,std::vector<uint64_t> &column_sizes) ///< <h3>Method to read a fetch reply of any valid shape</h3>
+{
+    /// <i>scan_fetch() covers the replies as sqreamd writes them, any other reply carrying rows and colSzs is parsed in full</i><br>
+    /// <b>return</b>(bool):&emsp; the reply is a chunk, false for an error reply or one without rows or colSzs
+    if(scan_fetch(reply,rows,column_sizes)) return true;
+    const json reply_json=json::parse(reply.begin(),reply.end(),nullptr,false);
+    if(!reply_json.is_object() or reply_json.contains("error")) return false;
+    const auto found_rows=reply_json.find("rows"),found_sizes=reply_json.find("colSzs");
+    if(found_rows==reply_json.end() or !found_rows->is_number_unsigned() or found_sizes==reply_json.end() or !found_sizes->is_array()) return false;
+    column_sizes.clear();
+    for(const json &size:*found_sizes) {
+        if(!size.is_number_unsigned()) return false;
+        column_sizes.push_back(size.get<uint64_t>());
+    }
+    rows=found_rows->get<uint64_t>();
+    return true;
+}
+
+static const char *chunk_layout_error(const std::vector<sqream::column> &metadata,uint64_t rows,const std::vector<uint64_t> &column_sizes) ///< <h3>Method to check the block sizes of a chunk against the output metadata</h3>
+{
+    /// <i>Every column must bring exactly its blocks, sized after the row count and the column width</i><br>
+    /// <b>return</b>(const char *):&emsp; what does not match, nullptr when the chunk matches the metadata
+    size_t k=0;
+    for(const sqream::column &c:metadata)
+    {
+        if(k+c.blocks>column_sizes.size()) return "fetched column sizes do not match metadata";
+        if(c.nullable and column_sizes[k++]!=rows) return "fetched null block does not match the row count";
+        if(c.is_true_varchar and column_sizes[k++]!=sizeof(int32_t)*rows) return "fetched length block does not match the row count";
+        if(!c.is_true_varchar and column_sizes[k]!=c.size*rows) return "fetched data block does not match the row count";
+        k++;
+    }
+    if(k!=column_sizes.size()) return "fetched column sizes do not match metadata";
+    return nullptr;
+}
+
+static bool acked(const std::vector<char> &reply,const char value[]) ///< <h3>Method to check an acknowledgement reply</h3>
+{
+    /// <i>Check a fixed acknowledgement with the scanner, falling back to a full parse for errors and unusual replies</i><br>
+    /// <b>return</b>(bool):&emsp; as verify_response()
+    if(scan_ack(reply,value)) return true;
+    json reply_json = json::parse(reply.begin(),reply.end());
+    return verify_response(reply_json, value);
+}
 
-static void rxtx(sqream::connector *conn, json& reply_json,const char input[]) ///< <h3>Method to send and receive formatted messages</h3>
+static void rxtx(sqream::connector *conn, json& reply_json,std::string_view frame) ///< <h3>Method to send a framed message and receive its reply</h3>
 {
-    /// <i>Routine to perform a send and receive of formatted JSON messages</i><br>
+    /// <i>Routine to perform a send and receive of a message already framed with its header</i><br>
     /// <b>input:</b>
     /// <ul>
     /// <li>sqream::connector *conn:&emsp; Pointer to SQream low level connector type</li>
     /// <li>json &reply_json:&emsp; JSON reply message from sqreamd</li>
-    /// <li>const char input[]:&emsp; JSON message to sqreamd</li>
+    /// <li>std::string_view frame:&emsp; framed message to sqreamd (MESSAGES::*_frame, frame_prepare)</li>
     /// </ul>
-
-    std::vector<char> reply_msg;
-    
-    conn->write(input,strlen(input),sqream::HEADER::HEADER_JSON);
-    conn->read(reply_msg);
-    
-    // add catch error - https://github.com/nlohmann/json/blob/develop/doc/examples/parse_error.cpp
-    reply_json = json::parse(std::string(reply_msg.begin(),reply_msg.end()).c_str()); // THROW_GENERAL_ERROR("could not parse server response");
+    if(!conn->socket) THROW_GENERAL_ERROR("not connected");
+    const TSockChunk chunk={frame.data(),frame.size()};
+    size_t bytes_written;
+    if(!conn->socket->SockWriteChunks(&chunk,1,bytes_written)) THROW_GENERAL_ERROR("socket failed to write message block");
+    conn->read(conn->reply_buffer_);
+    reply_json = json::parse(conn->reply_buffer_.begin(),conn->reply_buffer_.end());
 }
 
 template<typename ...Args> 
@@ -109,8 +296,201 @@ void rxtx(sqream::connector *conn, json& reply_json,const char input[],Args...ar
     conn->read(reply_msg);
     
     // add catch error - https://github.com/nlohmann/json/blob/develop/doc/examples/parse_error.cpp
-    reply_json = json::parse(std::string(reply_msg.begin(),reply_msg.end()).c_str()); //THROW_GENERAL_ERROR("could not parse server response");
+    reply_json = json::parse(reply_msg.begin(),reply_msg.end()); //THROW_GENERAL_ERROR("could not parse server response");
+
+}
+
+static void tx(sqream::connector *conn,std::span<const std::string_view> frames) ///< <h3>Method to send several messages back to back without waiting for replies</h3>
+{
+    /// <i>Routine to pipeline framed messages in a single socket write</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>sqream::connector *conn:&emsp; Pointer to SQream low level connector type</li>
+    /// <li>std::span<const std::string_view> frames:&emsp; messages to sqreamd with their headers (MESSAGES::*_frame, frame_put, frame_prepare), in order</li>
+    /// </ul>
+    /// Every message must later be matched with one rx() call, in the same order.
+    if(!conn->socket) THROW_GENERAL_ERROR("not connected");
+    TSockChunk chunks[16];
+    for(size_t sent=0;sent<frames.size();) {
+        size_t n=0;
+        for(;n<16 and sent<frames.size();n++,sent++) chunks[n]={frames[sent].data(),frames[sent].size()};
+        size_t bytes_written;
+        if(!conn->socket->SockWriteChunks(chunks,n,bytes_written)) THROW_GENERAL_ERROR("socket failed to write message block");
+    }
+}
+
+static void tx(sqream::connector *conn,std::initializer_list<std::string_view> frames) ///< <h3>Method to send a fixed list of messages back to back</h3>
+{
+    tx(conn,std::span<const std::string_view>(frames.begin(),frames.size()));
+}
+
+static void rx(sqream::connector *conn, json& reply_json) ///< <h3>Method to receive the reply of a message sent earlier</h3>
+{
+    /// <i>Routine to receive and parse the next JSON reply</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>sqream::connector *conn:&emsp; Pointer to SQream low level connector type</li>
+    /// <li>json &reply_json:&emsp; JSON reply message from sqreamd</li>
+    /// </ul>
+    std::vector<char> reply_msg;
+    conn->read(reply_msg);
+    reply_json = json::parse(reply_msg.begin(),reply_msg.end());
+}
+
+static bool parse_metadata_out(const json &reply_json,std::vector<sqream::column> &columns_metadata_out) ///< <h3>Method to parse a queryTypeOut reply</h3>
+{
+    /// <b>return</b>(bool):&emsp; the statement has output columns
+    columns_metadata_out.clear();
+    if(reply_json.contains("queryTypeNamed") and reply_json["queryTypeNamed"].is_array() and reply_json["queryTypeNamed"].size())
+    {
+        columns_metadata_out.resize(reply_json["queryTypeNamed"].size());
+        const json &out_array = reply_json["queryTypeNamed"];
+        auto out_size = out_array.size();
+        for(json::size_type i=0; i<out_size ;i++)
+        {
+            uint8_t checksum=0;
+            if(out_array[i].contains("isTrueVarChar")) columns_metadata_out[i].is_true_varchar = out_array[i]["isTrueVarChar"], checksum|=1;
+            if(out_array[i].contains("nullable")) columns_metadata_out[i].nullable = out_array[i]["nullable"], checksum|=2;
+            if(out_array[i].contains("name")) columns_metadata_out[i].name=std::string(out_array[i]["name"]), checksum|=4;
+            if(out_array[i].contains("type") and out_array[i]["type"].is_array() and out_array[i]["type"].size()==3)
+            {
+                columns_metadata_out[i].type=std::string(out_array[i]["type"][0]);
+                columns_metadata_out[i].size=out_array[i]["type"][1];
+                columns_metadata_out[i].scale=out_array[i]["type"][2];
+                checksum|=8;
+            }
+            if(checksum!=15) THROW_GENERAL_ERROR("could not parse metadata out");
+            columns_metadata_out[i].resolve();
+        }
+        return true;
+    }
+    return false;
+}
+
+static bool parse_metadata_in(const json &reply_json,std::vector<sqream::column> &columns_metadata_in) ///< <h3>Method to parse a queryTypeIn reply</h3>
+{
+    /// <b>return</b>(bool):&emsp; the statement has input columns
+    columns_metadata_in.clear();
+    if(reply_json.contains("queryType") and reply_json["queryType"].is_array() and reply_json["queryType"].size())
+    {
+        columns_metadata_in.resize(reply_json["queryType"].size());
+        const json &in_array = reply_json["queryType"];
+        for(size_t i=0; i<in_array.size(); i++)
+        {
+            uint8_t checksum=0;
+            if(in_array[i].contains("isTrueVarChar")) columns_metadata_in[i].is_true_varchar = in_array[i]["isTrueVarChar"], checksum|=1;
+            if(in_array[i].contains("nullable")) columns_metadata_in[i].nullable = in_array[i]["nullable"], checksum|=2;
+            if(in_array[i].contains("name") and in_array[i]["name"].is_string()) columns_metadata_in[i].name = in_array[i]["name"];
+            if(in_array[i].contains("type") and in_array[i]["type"].is_array() and in_array[i]["type"].size()==3)
+            {
+                columns_metadata_in[i].type=std::string(in_array[i]["type"][0]);
+                columns_metadata_in[i].size=in_array[i]["type"][1];
+                columns_metadata_in[i].scale=in_array[i]["type"][2];
+                checksum|=4;
+            }
+            if(checksum!=7) THROW_GENERAL_ERROR("could not parse metadata in");
+            columns_metadata_in[i].resolve();
+        }
+        return true;
+    }
+    return false;
+}
+
+static void name_metadata_in(const std::string &sql,std::vector<sqream::column> &columns_metadata_in) ///< <h3>Method to name insert columns after the column list of the statement</h3>
+{
+    /// <i>queryType replies carry no column names, so they are taken from "insert into t (a,b,..) values"</i><br>
+    /// Unquoted names are folded to lower case as sqreamd does. Statements without a column list, or whose list does
+    /// not match the metadata, leave the names untouched.
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const std::string &sql:&emsp; SQL text of the insert statement</li>
+    /// <li>std::vector<column> & columns_metadata_in:&emsp; parsed metadata of the insert statement</li>
+    /// </ul>
+    if(columns_metadata_in.empty() or !columns_metadata_in[0].name.empty()) return;
+    size_t pos=0;
+    auto skip=[&]() { while(pos<sql.size() and isspace((unsigned char)sql[pos])) pos++; };
+    auto word=[&](const char *keyword) {
+        skip();
+        for(;*keyword;keyword++,pos++) if(pos==sql.size() or tolower((unsigned char)sql[pos])!=*keyword) return false;
+        return true;
+    };
+    if(!word("insert") or !word("into")) return;
+    skip();
+    while(pos<sql.size() and sql[pos]!='(' and !isspace((unsigned char)sql[pos])) pos++;
+    skip();
+    if(pos==sql.size() or sql[pos]!='(') return;
+    std::vector<std::string> names(1);
+    bool quoted=false;
+    for(pos++;pos<sql.size();pos++) {
+        const char c=sql[pos];
+        if(c=='"') quoted=!quoted;
+        else if(quoted) names.back()+=c;
+        else if(c==',') names.emplace_back();
+        else if(c==')') break;
+        else if(!isspace((unsigned char)c)) names.back()+=(char)tolower((unsigned char)c);
+    }
+    if(pos==sql.size() or names.size()!=columns_metadata_in.size()) return;
+    for(size_t i=0;i<names.size();i++) columns_metadata_in[i].name=std::move(names[i]);
+}
+
+static bool redirected(const json &reply_json) ///< <h3>Method to check a prepareStatement reply asks to reconnect</h3>
+{
+    return reply_json.contains("reconnect") and (reply_json["reconnect"] == true);
+}
+
+static bool prepared(sqream::connector *conn,json &reply_json) ///< <h3>Method to handle a prepareStatement reply</h3>
+{
+    /// <i>Routine to check a statement was prepared, following a load balancer redirect if sqreamd asks for it</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>sqream::connector *conn:&emsp; Pointer to SQream low level connector type</li>
+    /// <li>json &reply_json:&emsp; prepareStatement reply from sqreamd</li>
+    /// </ul>
+    /// <b>return</b>(bool):&emsp; success from server
+    /// On a redirect the connection is replaced, so messages pipelined after prepareStatement are lost with the old socket.
+    if(redirected(reply_json)) {     
+        if((reply_json.contains("port") or reply_json.contains("port_ssl")) and reply_json.contains("ip") and reply_json.contains("listener_id")) {
+            const int port = conn->ssl_ ? reply_json["port_ssl"] : reply_json["port"];
+            if(conn->reconnect(reply_json["ip"], port, reply_json["listener_id"]));
+            else THROW_GENERAL_ERROR("reconnection failed");
+        }
+        else THROW_GENERAL_ERROR("could not parse reconnection message");
+        rxtx(conn, reply_json, sqream::MESSAGES::reconstructStatement,conn->statement_id_);
+        // ERR_HANDLE_STR(statementReconstructed)
+        return verify_response(reply_json, "statementReconstructed");
+    }
+    else { 
+        ERR_HANDLE(statementPrepared,GetBool)
+    }
+}
 
+static sqream::CONSTS::statement_type executed_metadata(sqream::connector *conn,std::vector<sqream::column> &columns_metadata_in,std::vector<sqream::column> &columns_metadata_out,json *prepare_reply=nullptr) ///< <h3>Method to read the replies of a pipelined execute and metadata query</h3>
+{
+    /// <i>Read the replies of pipelined execute, queryTypeOut and queryTypeIn messages</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>sqream::connector *conn:&emsp; Pointer to SQream low level connector type</li>
+    /// <li>std::vector<column> & columns_metadata_in:&emsp; metadata container on input table (for network instert)</li>
+    /// <li>std::vector<column> & columns_metadata_out:&emsp; metadata container on output table (for any select)</li>
+    /// <li>json *prepare_reply:&emsp; reply to a prepareStatement pipelined ahead of them, checked once all replies are read</li>
+    /// </ul>
+    /// All replies are consumed before any error is raised so the connection stays in sync.
+    std::vector<char> execute_reply;
+    json out_reply_json,in_reply_json;
+    conn->read(execute_reply);
+    rx(conn,out_reply_json);
+    rx(conn,in_reply_json);
+    if(prepare_reply and !prepared(conn,*prepare_reply)) THROW_GENERAL_ERROR("error preparing statement");
+    if(!acked(execute_reply,"executed")) THROW_GENERAL_ERROR("failed to execute query");
+    if(parse_metadata_out(out_reply_json,columns_metadata_out)) {
+        columns_metadata_in.clear();
+        return sqream::CONSTS::statement_type::select;
+    }
+    if(parse_metadata_in(in_reply_json,columns_metadata_in)) {
+        name_metadata_in(conn->statement_sql_,columns_metadata_in);
+        return sqream::CONSTS::statement_type::insert;
+    }
+    return sqream::CONSTS::statement_type::direct;
 }
 
 
@@ -122,6 +502,19 @@ sqream::connector::connector() {
 
     /// <i>ensure the socket is null pointer on object creation</i><br>
     socket=nullptr;
+    fetch_pipeline_=1;
+    fetch_window_=CONSTS::MAX_SIZE;
+    fetch_outstanding_=0;
+    last_chunk_size_=0;
+    put_bytes_=0;
+    statement_cache_size_=0;
+    held_rows_=0;
+    chunk_held_=false;
+    read_ahead_=CONSTS::READ_AHEAD;
+    ktls_=false;
+    io_backend_=CONSTS::blocking;
+    zerocopy_=false;
+    write_size_=0;
 }
 
 sqream::connector::~connector() {
@@ -130,13 +523,7 @@ sqream::connector::~connector() {
     if(socket) {
 
         int bytes_written;
-        const size_t data_size=strlen(MESSAGES::closeConnection);
-        const size_t block_size=HEADER::SIZE+sizeof(data_size);
-        std::vector<char> pillow(block_size+data_size);
-        memcpy(pillow.data(),HEADER::HEADER_JSON,HEADER::SIZE);
-        memcpy(&pillow[HEADER::SIZE],&data_size,sizeof(data_size));
-        memcpy(&pillow[block_size],MESSAGES::closeConnection,data_size);
-        socket->SockWriteChunk(pillow.data(),data_size+block_size,bytes_written);
+        socket->SockWriteChunk(MESSAGES::closeConnection_frame.bytes,sizeof(MESSAGES::closeConnection_frame.bytes),bytes_written);
     
         /// <i>ensure a disconnect on object destruction</i><br>
         /// <i>disconnect from a sqreamd session</i><br>
@@ -162,11 +549,15 @@ void sqream::connector::connect_socket(const std::string &ipv4,int port,bool ssl
         socket=nullptr;
     }
     socket=new(std::nothrow) TSocketClient(ipv4.c_str(),port,ssl);
+    socket->SockEnableKtls(ktls_);
 
     if(socket->SockCreateAndConnect()==false) {
         socket=nullptr;
         THROW_GENERAL_ERROR("unable to create socket");
     }
+    socket->SockSetReadAhead(read_ahead_);
+    if(io_backend_==CONSTS::uring) socket->SockSetBackend(SOCK_BACKEND_IO_URING);
+    if(zerocopy_) socket->SockEnableZeroCopy(true);
 }
 
 
@@ -191,6 +582,35 @@ void sqream::connector::read(std::vector<char> &data) {
         THROW_GENERAL_ERROR("not connected");
 }
 
+void sqream::connector::read(char *data,const uint64_t data_size,const void *buffer_set) {
+
+    /// <i>read a message of known size sent by sqreamd straight into its destination</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>char *data:&emsp; output buffer, at least data_size bytes</li>
+    /// <li>const uint64_t data_size:&emsp; size the message is expected to have</li>
+    /// <li>const void *buffer_set=nullptr:&emsp; registered buffer set the output buffer belongs to, see set_io_backend()</li>
+    /// </ul>
+    if(socket) {
+        char header[10];
+        uint64_t message_size;
+        int bytes_read;
+        if(!socket->SockReadChunk(header,bytes_read,sizeof(header))) THROW_GENERAL_ERROR("socket failed to read header");
+        if(header[0]!=HEADER::PROTOCOL_VERSION) {
+            drop_socket_();
+            THROW_GENERAL_ERROR("protocol version mismatch");
+        }
+        memcpy(&message_size,&header[2],sizeof(uint64_t));
+        /// <i>the unread body would be taken for the next reply, so the connection can not be used any further</i><br>
+        if(message_size!=data_size) {
+            drop_socket_();
+            THROW_GENERAL_ERROR("unexpected message size");
+        }
+        if(!socket->SockReadChunk(data,bytes_read,data_size,buffer_set)) THROW_GENERAL_ERROR("socket failed to read content");
+    }
+    else 
+        THROW_GENERAL_ERROR("not connected");
+}
 
 void sqream::connector::write(const char *data,const uint64_t data_size,const uint8_t msg_type[HEADER::SIZE]) {
 
@@ -201,22 +621,16 @@ void sqream::connector::write(const char *data,const uint64_t data_size,const ui
     /// <li>const size_t data_size:&emsp; size of data to be written</li>
     /// <li>const uint8_t msg_type[HEADER::SIZE]: message type indicator</li>
     /// </ul>
+    /// Binary messages of at least CONSTS::ZEROCOPY_MIN bytes go out with MSG_ZEROCOPY when set_zerocopy() is on,
+    /// data must then stay untouched until release_put_() returned.
     if(socket) {
         if(data_size<CONSTS::MAX_SIZE) {
-            int bytes_written;
-            if(!memcmp((const char*)msg_type,HEADER::HEADER_JSON,HEADER::SIZE)) {
-                const size_t block_size=HEADER::SIZE+sizeof(data_size);
-                std::vector<char> pillow(block_size+data_size);
-                memcpy(pillow.data(),msg_type,HEADER::SIZE);
-                memcpy(&pillow[HEADER::SIZE],&data_size,sizeof(data_size));
-                memcpy(&pillow[block_size],data,data_size);
-                if(!socket->SockWriteChunk(pillow.data(),data_size+block_size,bytes_written)) THROW_GENERAL_ERROR("socket failed to write message block");
-            }
-            else {
-                if(!socket->SockWriteChunk(msg_type,HEADER::SIZE,bytes_written)) THROW_GENERAL_ERROR("socket failed to write header");
-                if(!socket->SockWriteChunk(&data_size,sizeof(data_size),bytes_written)) THROW_GENERAL_ERROR("socket failed to write binary data size");
-                if(!socket->SockWriteChunk(data,data_size,bytes_written)) THROW_GENERAL_ERROR("socket failed to write binary data");
-            }
+            size_t bytes_written;
+            const bool zerocopy=msg_type[1]==HEADER::TYPE_BINARY and data_size>=CONSTS::ZEROCOPY_MIN;
+            /// <i>the kernel may send the header from its pages after returning, so it must outlive the call</i><br>
+            write_size_=data_size;
+            const TSockChunk chunks[]={{msg_type,HEADER::SIZE},{&write_size_,sizeof(write_size_)},{data,data_size}};
+            if(!socket->SockWriteChunks(chunks,3,bytes_written,nullptr,zerocopy)) THROW_GENERAL_ERROR("socket failed to write message block");
         }
         else THROW_GENERAL_ERROR("binary data overflow");
     }
@@ -273,7 +687,7 @@ bool sqream::connector::open_statement() {
     /// <i>Connector routine that opens a new statement on sqreamd</i><br>
     /// <b>return</b>(uint32_t):&emsp; statement_id
     json reply_json;
-    rxtx(this, reply_json,MESSAGES::getStatementId);
+    rxtx(this, reply_json,MESSAGES::getStatementId_frame.view());
     if(reply_json.contains("statementId")) {
         statement_id_=reply_json["statementId"];
         return true;
@@ -290,25 +704,103 @@ bool sqream::connector::prepare_statement(std::string sqlQuery,int chunk_size) {
     /// <li>int chunk_size:&emsp; this parameter is unparsed</li>
     /// </ul>
     /// <b>return</b>(bool):&emsp; success from server
-    json reply_json, prepare_json;
-    prepare_json["prepareStatement"] = sqlQuery;
-    prepare_json["chunkSize"] = chunk_size;
-	rxtx(this, reply_json, prepare_json.dump().c_str());
+    json reply_json;
+    statement_sql_=sqlQuery;
+    rxtx(this, reply_json, MESSAGES::frame_prepare(frame_buffer_,sqlQuery,chunk_size));
+    return prepared(this,reply_json);
+}
 
-    if(reply_json.contains("reconnect") and (reply_json["reconnect"] == true)) {     
-        if((reply_json.contains("port") or reply_json.contains("port_ssl")) and reply_json.contains("ip") and reply_json.contains("listener_id")) {
-            const int port = ssl_ ? reply_json["port_ssl"] : reply_json["port"];
-            if(reconnect(reply_json["ip"], port, reply_json["listener_id"]));
-            else THROW_GENERAL_ERROR("reconnection failed");
-        }
-        else THROW_GENERAL_ERROR("could not parse reconnection message");
-        rxtx(this, reply_json, MESSAGES::reconstructStatement,statement_id_);
-        // ERR_HANDLE_STR(statementReconstructed)
-        return verify_response(reply_json, "statementReconstructed");
+bool sqream::connector::open_prepare_statement(std::string sqlQuery,int chunk_size) {
+    /// <i>Connector routine that opens and prepares a statement on sqreamd in a single round trip</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>std::string sqlQuery:&emsp; sql query string (this is the actual sql query)</li>
+    /// <li>int chunk_size:&emsp; this parameter is unparsed</li>
+    /// </ul>
+    /// <b>return</b>(bool):&emsp; success from server
+    json id_reply_json,reply_json;
+    statement_sql_=sqlQuery;
+    tx(this,{MESSAGES::getStatementId_frame.view(),MESSAGES::frame_prepare(frame_buffer_,sqlQuery,chunk_size)});
+    rx(this,id_reply_json);
+    rx(this,reply_json);
+    if(id_reply_json.contains("statementId")) statement_id_=id_reply_json["statementId"];
+    else if(id_reply_json.contains("error")) THROW_SQREAM_ERROR(id_reply_json["error"]);
+    else THROW_GENERAL_ERROR("could not open statement");
+    return prepared(this,reply_json);
+}
+
+sqream::CONSTS::statement_type sqream::connector::execute_metadata_query(std::vector<column> &columns_metadata_in,std::vector<column> &columns_metadata_out)
+{
+    /// <i>Connector routine that executes a statement and retrieves its metadata in a single round trip</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>std::vector<column> & columns_metadata_in:&emsp; metadata container on input table (for network instert)</li>
+    /// <li>std::vector<column> & columns_metadata_out:&emsp; metadata container on output table (for any select)</li>
+    /// </ul>
+    /// <b>return</b>(sqream::CONSTS::statement type): statement type, as metadata_query()
+    /// queryTypeIn is sent ahead for every statement and its reply is ignored when the statement has output columns.
+    /// Statements found in the statement cache are only executed, their metadata is taken from the cache.
+    chunk_held_=false;
+    if(const cached_statement *cached=find_statement_(statement_sql_)) {
+        if(!execute()) THROW_GENERAL_ERROR("failed to execute query");
+        columns_metadata_in=cached->metadata_in;
+        columns_metadata_out=cached->metadata_out;
+        const CONSTS::statement_type type=cached->type;
+        if(type==CONSTS::statement_type::select) hold_first_chunk_(columns_metadata_out);
+        return type;
     }
-    else { 
-        ERR_HANDLE(statementPrepared,GetBool)
+    tx(this,{MESSAGES::execute_frame.view(),MESSAGES::queryTypeOut_frame.view(),MESSAGES::queryTypeIn_frame.view()});
+    CONSTS::statement_type retval=executed_metadata(this,columns_metadata_in,columns_metadata_out);
+    cache_statement_(retval,columns_metadata_in,columns_metadata_out);
+    return retval;
+}
+
+sqream::CONSTS::statement_type sqream::connector::open_prepare_execute(std::string sqlQuery,int chunk_size,std::vector<column> &columns_metadata_in,std::vector<column> &columns_metadata_out)
+{
+    /// <i>Connector routine that opens, prepares and executes a statement and retrieves its metadata in a single round trip</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>std::string sqlQuery:&emsp; sql query string (this is the actual sql query)</li>
+    /// <li>int chunk_size:&emsp; this parameter is unparsed</li>
+    /// <li>std::vector<column> & columns_metadata_in:&emsp; metadata container on input table (for network instert)</li>
+    /// <li>std::vector<column> & columns_metadata_out:&emsp; metadata container on output table (for any select)</li>
+    /// </ul>
+    /// <b>return</b>(sqream::CONSTS::statement type): statement type, as metadata_query()
+    /// When sqreamd redirects the statement to another instance, the messages pipelined after prepareStatement are
+    /// dropped with the old socket and sent again on the new one once the statement is reconstructed.
+    /// Statements found in the statement cache skip queryTypeOut and queryTypeIn, their metadata is taken from the cache.
+    json id_reply_json,reply_json;
+    statement_sql_=sqlQuery;
+    chunk_held_=false;
+    const std::string_view prepare_msg=MESSAGES::frame_prepare(frame_buffer_,sqlQuery,chunk_size);
+    const cached_statement *cached=find_statement_(sqlQuery);
+    if(cached) tx(this,{MESSAGES::getStatementId_frame.view(),prepare_msg,MESSAGES::execute_frame.view()});
+    else tx(this,{MESSAGES::getStatementId_frame.view(),prepare_msg,MESSAGES::execute_frame.view(),MESSAGES::queryTypeOut_frame.view(),MESSAGES::queryTypeIn_frame.view()});
+    rx(this,id_reply_json);
+    rx(this,reply_json);
+    if(id_reply_json.contains("statementId")) statement_id_=id_reply_json["statementId"];
+    if(redirected(reply_json)) {
+        if(!id_reply_json.contains("statementId")) THROW_GENERAL_ERROR("could not open statement");
+        if(!prepared(this,reply_json)) THROW_GENERAL_ERROR("error preparing statement");
+        return execute_metadata_query(columns_metadata_in,columns_metadata_out);
+    }
+    CONSTS::statement_type retval;
+    if(cached) {
+        read(reply_buffer_);
+        if(!prepared(this,reply_json)) THROW_GENERAL_ERROR("error preparing statement");
+        if(!acked(reply_buffer_,"executed")) THROW_GENERAL_ERROR("failed to execute query");
+        columns_metadata_in=cached->metadata_in;
+        columns_metadata_out=cached->metadata_out;
+        retval=cached->type;
     }
+    else retval=executed_metadata(this,columns_metadata_in,columns_metadata_out,&reply_json);
+    if(!id_reply_json.contains("statementId")) {
+        if(id_reply_json.contains("error")) THROW_SQREAM_ERROR(id_reply_json["error"]);
+        THROW_GENERAL_ERROR("could not open statement");
+    }
+    if(!cached) cache_statement_(retval,columns_metadata_in,columns_metadata_out);
+    else if(retval==CONSTS::statement_type::select) hold_first_chunk_(columns_metadata_out);
+    return retval;
 }
 
 sqream::CONSTS::statement_type sqream::connector::metadata_query(std::vector<column> &columns_metadata_in,std::vector<column> &columns_metadata_out)
@@ -329,52 +821,15 @@ sqream::CONSTS::statement_type sqream::connector::metadata_query(std::vector<col
     columns_metadata_in.clear();
     CONSTS::statement_type retval=CONSTS::statement_type::unset;
     json queryTypeOut_reply_json;
-    rxtx(this, queryTypeOut_reply_json,MESSAGES::queryTypeOut);
-    if(queryTypeOut_reply_json.contains("queryTypeNamed") and queryTypeOut_reply_json["queryTypeNamed"].is_array() and queryTypeOut_reply_json["queryTypeNamed"].size())
-    {
-        retval=CONSTS::statement_type::select;
-        columns_metadata_out.resize(queryTypeOut_reply_json["queryTypeNamed"].size());
-        const json &out_array = queryTypeOut_reply_json["queryTypeNamed"];
-        auto out_size = out_array.size();
-        for(json::size_type i=0; i<out_size ;i++)
-        {
-            uint8_t checksum=0;
-            if(out_array[i].contains("isTrueVarChar")) columns_metadata_out[i].is_true_varchar = out_array[i]["isTrueVarChar"], checksum|=1;
-            if(out_array[i].contains("nullable")) columns_metadata_out[i].nullable = out_array[i]["nullable"], checksum|=2;
-            if(out_array[i].contains("name")) columns_metadata_out[i].name=std::string(out_array[i]["name"]), checksum|=4;
-            if(out_array[i].contains("type") and out_array[i]["type"].is_array() and out_array[i]["type"].size()==3)
-            {
-                columns_metadata_out[i].type=std::string(out_array[i]["type"][0]);
-                columns_metadata_out[i].size=out_array[i]["type"][1];
-                columns_metadata_out[i].scale=out_array[i]["type"][2];
-                checksum|=8;
-            }
-            if(checksum!=15) THROW_GENERAL_ERROR("could not parse metadata out");
-        }
-    }
+    rxtx(this, queryTypeOut_reply_json,MESSAGES::queryTypeOut_frame.view());
+    if(parse_metadata_out(queryTypeOut_reply_json,columns_metadata_out)) retval=CONSTS::statement_type::select;
     else
     {
         json queryTypeIn_reply_json;
-        rxtx(this, queryTypeIn_reply_json,MESSAGES::queryTypeIn);
-        if(queryTypeIn_reply_json.contains("queryType") and queryTypeIn_reply_json["queryType"].is_array() and queryTypeIn_reply_json["queryType"].size())
-        {
+        rxtx(this, queryTypeIn_reply_json,MESSAGES::queryTypeIn_frame.view());
+        if(parse_metadata_in(queryTypeIn_reply_json,columns_metadata_in)) {
+            name_metadata_in(statement_sql_,columns_metadata_in);
             retval=CONSTS::statement_type::insert;
-            columns_metadata_in.resize(queryTypeIn_reply_json["queryType"].size());
-            const json &in_array = queryTypeIn_reply_json["queryType"];
-            for(size_t i=0; i<in_array.size(); i++)
-            {
-                uint8_t checksum=0;
-                if(in_array[i].contains("isTrueVarChar")) columns_metadata_in[i].is_true_varchar = in_array[i]["isTrueVarChar"], checksum|=1;
-                if(in_array[i].contains("nullable")) columns_metadata_in[i].nullable = in_array[i]["nullable"], checksum|=2;
-                if(in_array[i].contains("type") and in_array[i]["type"].is_array() and in_array[i]["type"].size()==3)
-                {
-                    columns_metadata_in[i].type=std::string(in_array[i]["type"][0]);
-                    columns_metadata_in[i].size=in_array[i]["type"][1];
-                    columns_metadata_in[i].scale=in_array[i]["type"][2];
-                    checksum|=4;
-                }
-                if(checksum!=7) THROW_GENERAL_ERROR("could not parse metadata in");
-            }
         }
         else retval=CONSTS::statement_type::direct;
     }
@@ -385,96 +840,615 @@ bool sqream::connector::execute()
 {
     /// <i>Connector routine that tells the server to execute a statement</i><br>
     /// <b>return</b>(bool):&emsp; success response from sqreamd
-    json reply_json;
-    rxtx(this, reply_json,MESSAGES::execute);
-
-    // ERR_HANDLE_STR(executed)
-    bool res = verify_response(reply_json, "executed");
-    return res;
-    // puts ("execute end");
-
+    tx(this,{MESSAGES::execute_frame.view()});
+    read(reply_buffer_);
+    return acked(reply_buffer_,"executed");
 }
 
-size_t sqream::connector::fetch(std::vector<char> &binary_data,std::vector<uint64_t> &column_sizes,size_t min_size)
+size_t sqream::connector::fetch(raw_buffer &binary_data,std::vector<uint64_t> &column_sizes,size_t min_size)
 {
     /// <i>Connector routine that retrieves serialized output data from the server</i><br>
     /// <b>input:</b>
     /// <ul>
-    /// <li>std::vector<char> &binary_data:&emsp; retrieved data buffer</li>
+    /// <li>raw_buffer &binary_data:&emsp; retrieved data buffer, its capacity is reused</li>
     /// <li>size_t min_size=1:&emsp; keep retrieving until at least size of bytes is retrieved (default value is 1)</li>
     /// </ul>
     /// <b>return</b>(size_t):&emsp; number of rows
-    json reply_json;
+    /// Up to fetch_pipeline_ requests are kept in flight so the next chunks are already on their way while one is read,
+    /// as long as that many chunks of the last seen size fit in fetch_window_. The replies arrive in request order.
+    /// Every chunk is received straight into binary_data, grown to the size announced by colSzs without being zero filled.
+    /// The first chunk of a cached select, already read by hold_first_chunk_(), is handed out alone.
+    if(chunk_held_) {
+        chunk_held_=false;
+        binary_data.swap(held_chunk_);
+        column_sizes.swap(held_sizes_);
+        return held_rows_;
+    }
     binary_data.resize(0);
     column_sizes.resize(0);
     size_t row_count=0;
-    while(binary_data.size()<min_size)
+    bool exhausted=false;
+    while(binary_data.size()<min_size and !exhausted)
     {
-        rxtx(this, reply_json,MESSAGES::fetch);
-        if(reply_json.contains("colSzs") and reply_json.contains("rows"))
+        static const std::string_view fetch_frames[]={MESSAGES::fetch_frame.view(),MESSAGES::fetch_frame.view(),MESSAGES::fetch_frame.view(),MESSAGES::fetch_frame.view(),
+                                                      MESSAGES::fetch_frame.view(),MESSAGES::fetch_frame.view(),MESSAGES::fetch_frame.view(),MESSAGES::fetch_frame.view()};
+        size_t requests=0;
+        while(!(fetch_outstanding_+requests) or (fetch_outstanding_+requests<fetch_pipeline_ and (fetch_outstanding_+requests+1)*last_chunk_size_<=fetch_window_))
+            requests++;
+        for(size_t sent=0;sent<requests;sent+=std::size(fetch_frames))
+            tx(this,std::span<const std::string_view>(fetch_frames,std::min(requests-sent,std::size(fetch_frames))));
+        fetch_outstanding_+=requests;
+        read(reply_buffer_);
+        fetch_outstanding_--;
+        uint64_t rows;
+        if(read_fetch(reply_buffer_,rows,column_sizes))
         {
-            if(reply_json["colSzs"].is_array() and reply_json["colSzs"].size())
+            exhausted=true;
+            if(column_sizes.size())
             {
-                row_count += int(reply_json["rows"]);
-                const json &array = reply_json["colSzs"];
-                const auto I = array.size();
-                if(column_sizes.size() != I) column_sizes.resize(I);
+                row_count += rows;
                 size_t binary_size=0;
-                for(json::size_type i=0; i<I ;i++) {
-                    binary_size += column_sizes[i] = array[i];
-                }
+                for(uint64_t size:column_sizes) binary_size += size;
                 if(binary_size>0)
                 {       
-                    std::vector<char> temp(binary_size);
-                    read(temp);
-                    binary_data.insert(binary_data.end(),temp.begin(),temp.end());
+                    const size_t offset=binary_data.size();
+                    binary_data.resize(offset+binary_size);
+                    const void *buffer_set=nullptr;
+                    if(socket->SockBackend()==SOCK_BACKEND_IO_URING) {
+                        /// Keyed by the allocation, so the buffers the prefetcher recycles each keep their own set
+                        /// and the table is only registered again when one of them grows
+                        const TSockChunk buffer{binary_data.data(),binary_data.capacity()};
+                        if(socket->SockRegisterBuffers(buffer.pBuffer,&buffer,1)) buffer_set=buffer.pBuffer;
+                    }
+                    read(binary_data.data()+offset,binary_size,buffer_set);
+                    last_chunk_size_=binary_size;
+                    exhausted=false;
                 }
-                else break;
             }
-            else break;
         }
-        else if(reply_json.contains("error")) THROW_SQREAM_ERROR(reply_json["error"]);
-        else THROW_GENERAL_ERROR("sqream::connector::fetch: an unknown error occured");
+        else {
+            /// Replies of the requests still in flight would be taken for the ones of the next messages
+            if(fetch_outstanding_) drop_socket_();
+            json reply_json = json::parse(reply_buffer_.begin(),reply_buffer_.end());
+            if(reply_json.contains("error")) THROW_SQREAM_ERROR(reply_json["error"]);
+            else THROW_GENERAL_ERROR("sqream::connector::fetch: an unknown error occured");
+        }
     }
+    /// <i>requests sent past the end of the result set are answered empty</i><br>
+    if(exhausted) drain_fetches();
     return row_count;
 }
 
-void sqream::connector::put(std::vector<char> &binary_data,size_t rows)
+void sqream::connector::set_fetch_pipeline(uint32_t depth,uint64_t window)
 {
-    /// <i>Connector routine that sends serialized input data to the server</i><br>
+    /// <i>Keep several fetch requests in flight to hide the round trip per chunk</i><br>
     /// <b>input:</b>
     /// <ul>
-    /// <li>std::vector<char> &binary_data:&emsp; input data buffer</li>
-    /// <li>size_t rows:&emsp; number of rows that the input data buffer contains</li>
+    /// <li>uint32_t depth:&emsp; maximum number of fetch requests in flight, 1 waits for every reply before the next request (default)</li>
+    /// <li>uint64_t window:&emsp; no further request is sent while this many bytes of chunks of the last seen size would be in flight</li>
     /// </ul>
-    std::vector<char> msg,reply_msg;
-    json reply_json;
-    MESSAGES::format(msg,MESSAGES::put,rows);
-    write(msg.data(),msg.size(),HEADER::HEADER_JSON);
-    write(binary_data.data(),binary_data.size(),HEADER::HEADER_BINARY);
-    read(reply_msg);
-    reply_json = json::parse(std::string(reply_msg.begin(),reply_msg.end()).c_str());
-    if(reply_json.contains("putted") and (reply_json["putted"] == "putted")) 
-        return;
-    else if(reply_json.contains("error")) 
-        THROW_SQREAM_ERROR(reply_json["error"]);
-    else 
-        THROW_GENERAL_ERROR("sqream::connector::put: an unknown error occured");
+    if(!depth) THROW_GENERAL_ERROR("fetch pipeline depth must be at least 1");
+    fetch_pipeline_=depth;
+    fetch_window_=window;
 }
 
-bool sqream::connector::close_statement()
+void sqream::connector::set_statement_cache(size_t capacity)
 {
-    /// <i>Connector routine that closes a statement indicating it will not be used again</i><br>
-    /// <b>return</b>(bool):&emsp; success response from sqreamd
-    json reply_json;
-    rxtx(this, reply_json,MESSAGES::closeStatement);
-    // ERR_HANDLE_STR(statementClosed)
-    return verify_response(reply_json, "statementClosed");
+    /// <i>Remember the type and metadata of recently executed selects and inserts by their SQL text</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>size_t capacity:&emsp; most statements kept, least recently used ones are evicted first, 0 disables the cache (default)</li>
+    /// </ul>
+    /// Executing a cached statement again skips the queryTypeOut/queryTypeIn messages and the parsing of their replies.
+    /// sqreamd still needs every statement opened and prepared, so those messages are always sent.
+    /// Any direct statement (e.g. DDL) executed on the connection empties the cache, since it may change the tables the cached metadata describes.
+    statement_cache_size_=capacity;
+    while(statement_cache_.size()>statement_cache_size_) {
+        statement_index_.erase(statement_cache_.back().sql);
+        statement_cache_.pop_back();
+    }
+}
+
+void sqream::connector::set_read_ahead(size_t bytes)
+{
+    /// <i>Size the buffer replies are read ahead into</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>size_t bytes:&emsp; read-ahead buffer size, 0 reads straight from the socket (default CONSTS::READ_AHEAD)</li>
+    /// </ul>
+    /// A reply header and a small reply body, often several pipelined replies, come in with a single socket read.
+    /// Reads of at least this many bytes, e.g. large fetched chunks, bypass the buffer and land straight in the caller's one.
+    read_ahead_=bytes;
+    if(socket) socket->SockSetReadAhead(bytes);
+}
+
+void sqream::connector::set_ktls(bool enable)
+{
+    /// <i>Let the Linux kernel encrypt TLS records (kTLS) on the sockets opened from now on, including reconnects</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>bool enable:&emsp; ask OpenSSL to hand the record layer to the kernel after the handshake (default false)</li>
+    /// </ul>
+    /// Bulk put data is then written with plain vectored sends, without being copied into TLS records in user space.
+    /// Without the tls kernel module, a supported cipher or an OpenSSL built with kTLS, connections silently stay in user space TLS.
+    ktls_=enable;
+}
+
+bool sqream::connector::ktls_active()
+{
+    /// <b>return</b>(bool):&emsp; the kernel encrypts what is sent on the current connection
+    return socket and socket->SockKtlsActive();
+}
+
+bool sqream::connector::set_io_backend(CONSTS::io_backend backend)
+{
+    /// <i>Pick how the socket moves bytes, for the current connection and the ones opened from now on</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>CONSTS::io_backend backend:&emsp; CONSTS::blocking send/recv calls (default), or CONSTS::uring submissions to an io_uring</li>
+    /// </ul>
+    /// <b>return</b>(bool):&emsp; the backend is in use on the current connection, or will be tried on the next one when not connected
+    /// With io_uring the vectored put blocks go out as linked requests of a single system call, and the insert and fetch
+    /// buffers are registered with the kernel once per statement instead of being pinned on every transfer.
+    /// TLS connections and kernels without io_uring keep the blocking calls, a refused registration (e.g. RLIMIT_MEMLOCK) plain requests.
+    io_backend_=backend;
+    if(!socket) return true;
+    return socket->SockSetBackend(backend==CONSTS::uring ? SOCK_BACKEND_IO_URING : SOCK_BACKEND_BLOCKING);
+}
+
+sqream::CONSTS::io_backend sqream::connector::io_backend()
+{
+    /// <b>return</b>(CONSTS::io_backend):&emsp; backend the current connection transfers with
+    return socket and socket->SockBackend()==SOCK_BACKEND_IO_URING ? CONSTS::uring : CONSTS::blocking;
+}
+
+bool sqream::connector::set_zerocopy(bool enable)
+{
+    /// <i>Send the binary put messages of at least CONSTS::ZEROCOPY_MIN bytes with MSG_ZEROCOPY, on the current connection and the ones opened from now on</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>bool enable:&emsp; let the kernel send straight from the insert buffers instead of copying them (default false)</li>
+    /// </ul>
+    /// <b>return</b>(bool):&emsp; zero copy is in use on the current connection, or will be tried on the next one when not connected
+    /// A put returns only once the kernel released the pages it sent from, so the insert buffer ring never refills a buffer still in flight.
+    /// TLS connections and kernels without SO_ZEROCOPY keep copying, as do connections the kernel reports it had to copy for anyway (e.g. loopback).
+    zerocopy_=enable;
+    if(!socket) return true;
+    return socket->SockEnableZeroCopy(enable);
+}
+
+bool sqream::connector::zerocopy_active()
+{
+    /// <b>return</b>(bool):&emsp; large binary messages are sent from the caller's buffers on the current connection
+    return socket and socket->SockZeroCopyActive();
+}
+
+void sqream::connector::release_put_()
+{
+    /// <i>Wait until the kernel completed every zero copy send made so far, returns at once when there is none</i><br>
+    if(socket and !socket->SockZeroCopyWait(socket->SockZeroCopySent())) THROW_GENERAL_ERROR("socket failed to release zero copy buffers");
+}
+
+const sqream::cached_statement *sqream::connector::find_statement_(const std::string &sqlQuery)
+{
+    /// <i>Look a statement up in the cache and mark it as most recently used</i><br>
+    /// <b>return</b>(const cached_statement *):&emsp; cached statement or nullptr
+    if(!statement_cache_size_) return nullptr;
+    auto found=statement_index_.find(sqlQuery);
+    if(found==statement_index_.end()) return nullptr;
+    statement_cache_.splice(statement_cache_.begin(),statement_cache_,found->second);
+    return &*found->second;
+}
+
+void sqream::connector::cache_statement_(CONSTS::statement_type type,const std::vector<column> &columns_metadata_in,const std::vector<column> &columns_metadata_out)
+{
+    /// <i>Remember the newest statement, or empty the cache when it was a direct statement</i><br>
+    if(!statement_cache_size_) return;
+    if(type==CONSTS::statement_type::direct) {
+        statement_cache_.clear();
+        statement_index_.clear();
+        return;
+    }
+    if(statement_index_.count(statement_sql_)) return;
+    statement_cache_.push_front(cached_statement{statement_sql_,type,columns_metadata_in,columns_metadata_out});
+    statement_index_[statement_sql_]=statement_cache_.begin();
+    if(statement_cache_.size()>statement_cache_size_) {
+        statement_index_.erase(statement_cache_.back().sql);
+        statement_cache_.pop_back();
+    }
+}
+
+void sqream::connector::refresh_metadata_(std::vector<column> &columns_metadata_out)
+{
+    /// <i>Replace cached output metadata that does not match the fetched chunks</i><br>
+    /// The cache is only invalidated by direct statements on the same connection, so a table altered or
+    /// replaced by another session is noticed when the block sizes of the first chunk disagree with it.
+    /// Must be called with no fetch request in flight.
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>std::vector<column> & columns_metadata_out:&emsp; stale metadata, overwritten with the current one</li>
+    /// </ul>
+    const auto found=statement_index_.find(statement_sql_);
+    if(found!=statement_index_.end()) {
+        statement_cache_.erase(found->second);
+        statement_index_.erase(found);
+    }
+    std::vector<column> columns_metadata_in;
+    const CONSTS::statement_type type=metadata_query(columns_metadata_in,columns_metadata_out);
+    if(type!=CONSTS::statement_type::select) THROW_GENERAL_ERROR("cached select statement no longer returns columns");
+    cache_statement_(type,columns_metadata_in,columns_metadata_out);
+}
+
+void sqream::connector::hold_first_chunk_(std::vector<column> &columns_metadata_out)
+{
+    /// <i>Read the first chunk of a cached select and check the cached output metadata against it</i><br>
+    /// The chunk is fetched alone so nothing is in flight when the metadata has to be queried again,
+    /// then kept for the next fetch(). Runs before the metadata is returned from the execute call.
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>std::vector<column> & columns_metadata_out:&emsp; cached metadata, overwritten when stale</li>
+    /// </ul>
+    const uint32_t depth=fetch_pipeline_;
+    fetch_pipeline_=1;
+    try {
+        held_rows_=fetch(held_chunk_,held_sizes_);
+    }
+    catch(...) {
+        fetch_pipeline_=depth;
+        throw;
+    }
+    fetch_pipeline_=depth;
+    chunk_held_=true;
+    if(held_rows_ and chunk_layout_error(columns_metadata_out,held_rows_,held_sizes_)) refresh_metadata_(columns_metadata_out);
+}
+
+void sqream::connector::drop_socket_()
+{
+    /// <i>Close the socket after a failure that left unread replies on it</i><br>
+    /// The connector then reports itself as not connected until connect_socket() is called again.
+    fetch_outstanding_=0;
+    if(socket) {
+        socket->SockClose();
+        delete socket;
+        socket=nullptr;
+    }
+}
+
+void sqream::connector::drain_fetches()
+{
+    /// <i>Read and drop the replies of fetch requests still in flight</i><br>
+    /// Must be done before any other message is sent on the statement.
+    std::vector<uint64_t> column_sizes;
+    while(fetch_outstanding_)
+    {
+        read(reply_buffer_);
+        fetch_outstanding_--;
+        uint64_t rows,binary_size=0;
+        if(read_fetch(reply_buffer_,rows,column_sizes))
+        {
+            for(uint64_t size:column_sizes) binary_size+=size;
+            if(binary_size>0) read(reply_buffer_);
+        }
+    }
+}
+
+void sqream::connector::put(std::vector<char> &binary_data,size_t rows)
+{
+    /// <i>Connector routine that sends serialized input data to the server</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>std::vector<char> &binary_data:&emsp; input data buffer</li>
+    /// <li>size_t rows:&emsp; number of rows that the input data buffer contains</li>
+    /// </ul>
+    char msg[MESSAGES::PUT_FRAME_SIZE];
+    tx(this,{MESSAGES::frame_put(msg,rows)});
+    write(binary_data.data(),binary_data.size(),HEADER::HEADER_BINARY);
+    put_bytes_+=binary_data.size();
+    read(reply_buffer_);
+    release_put_();
+    if(scan_ack(reply_buffer_,"putted")) 
+        return;
+    json reply_json = json::parse(reply_buffer_.begin(),reply_buffer_.end());
+    if(reply_json.contains("error")) 
+        THROW_SQREAM_ERROR(reply_json["error"]);
+    else 
+        THROW_GENERAL_ERROR("sqream::connector::put: an unknown error occured");
+}
+
+void sqream::connector::put(const std::vector<std::vector<std::vector<char>>> &column_blocks,size_t rows)
+{
+    /// <i>Connector routine that sends input data to the server straight from its column blocks</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const std::vector<std::vector<std::vector<char>>> &column_blocks:&emsp; per column null, length and data blocks, in wire order</li>
+    /// <li>size_t rows:&emsp; number of rows that the blocks contain</li>
+    /// </ul>
+    /// The put message, the binary header and every block go out in one vectored write, without being joined first.
+    if(!socket) THROW_GENERAL_ERROR("not connected");
+    char msg[MESSAGES::PUT_FRAME_SIZE+HEADER::SIZE+sizeof(uint64_t)];
+    const std::string_view put_frame=MESSAGES::frame_put(msg,rows);
+    uint64_t data_size=0;
+    for(const std::vector<std::vector<char>> &blocks:column_blocks) for(const std::vector<char> &block:blocks) data_size+=block.size();
+    if(data_size>=CONSTS::MAX_SIZE) THROW_GENERAL_ERROR("binary data overflow");
+
+    char *binary_header=msg+put_frame.size();
+    memcpy(binary_header,HEADER::HEADER_BINARY,HEADER::SIZE);
+    memcpy(binary_header+HEADER::SIZE,&data_size,sizeof(data_size));
+
+    std::vector<TSockChunk> chunks{{msg,put_frame.size()+HEADER::SIZE+sizeof(data_size)}};
+    for(const std::vector<std::vector<char>> &blocks:column_blocks) for(const std::vector<char> &block:blocks) if(!block.empty()) chunks.push_back({block.data(),block.size()});
+    /// <i>the io_uring backend sends the blocks from registered memory, their whole capacity is registered once per insert buffer</i><br>
+    const void *buffer_set=nullptr;
+    if(socket->SockBackend()==SOCK_BACKEND_IO_URING) {
+        registered_buffers_.clear();
+        for(const std::vector<std::vector<char>> &blocks:column_blocks) for(const std::vector<char> &block:blocks) registered_buffers_.push_back({block.data(),block.capacity()});
+        if(socket->SockRegisterBuffers(&column_blocks,registered_buffers_.data(),registered_buffers_.size())) buffer_set=&column_blocks;
+    }
+    size_t bytes_written;
+    if(!socket->SockWriteChunks(chunks.data(),chunks.size(),bytes_written,buffer_set,data_size>=CONSTS::ZEROCOPY_MIN)) THROW_GENERAL_ERROR("socket failed to write binary data");
+    put_bytes_+=data_size;
+
+    read(reply_buffer_);
+    release_put_();
+    if(scan_ack(reply_buffer_,"putted")) 
+        return;
+    json reply_json = json::parse(reply_buffer_.begin(),reply_buffer_.end());
+    if(reply_json.contains("error")) 
+        THROW_SQREAM_ERROR(reply_json["error"]);
+    else 
+        THROW_GENERAL_ERROR("sqream::connector::put: an unknown error occured");
+}
+
+bool sqream::connector::close_statement()
+{
+    /// <i>Connector routine that closes a statement indicating it will not be used again</i><br>
+    /// <b>return</b>(bool):&emsp; success response from sqreamd
+    drain_fetches();
+    last_chunk_size_=0;
+    chunk_held_=false;
+    tx(this,{MESSAGES::closeStatement_frame.view()});
+    read(reply_buffer_);
+    /// <i>the buffers registered for the statement may be freed once it is closed</i><br>
+    if(socket) socket->SockUnregisterBuffers();
+    return acked(reply_buffer_,"statementClosed");
+}
+
+#undef ERR_HANDLE
+#undef ERR_HANDLE_STR
+
+
+//   ----  Column object
+//   -------------------
+
+void sqream::column::resolve() {
+    /// <i>Resolve the type code and where the column blocks sit, once per parsed metadata</i><br>
+    /// Blocks are sent per column as [null flags][value lengths][data], the first two only being present
+    /// for nullable and true varchar columns respectively. Unknown type names resolve to CONSTS::ftUnknown.
+    static const std::unordered_map<std::string,CONSTS::column_type> codes={
+        {"ftBool",CONSTS::ftBool},{"ftUByte",CONSTS::ftUByte},{"ftShort",CONSTS::ftShort},{"ftInt",CONSTS::ftInt},
+        {"ftLong",CONSTS::ftLong},{"ftFloat",CONSTS::ftFloat},{"ftDouble",CONSTS::ftDouble},{"ftDate",CONSTS::ftDate},
+        {"ftDateTime",CONSTS::ftDateTime},{"ftVarchar",CONSTS::ftVarchar},{"ftBlob",CONSTS::ftBlob}};
+    const auto found=codes.find(type);
+    type_code=found==codes.end() ? CONSTS::ftUnknown : found->second;
+    uint8_t next=0;
+    null_block=nullable ? next++ : CONSTS::NO_BLOCK;
+    length_block=is_true_varchar ? next++ : CONSTS::NO_BLOCK;
+    data_block=next++;
+    blocks=next;
+}
+
+
+//   ----  Result batch object
+//   -------------------------
+
+void sqream::result_batch::index(const std::vector<column> &metadata) {
+    /// <i>Resolve where the blocks of every column start inside the fetched buffer</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>std::vector<column> &metadata:&emsp; output metadata of the statement</li>
+    /// </ul>
+    /// Blocks are laid out per column as [null flags][value lengths][data], the first two only being present
+    /// for nullable and true varchar columns respectively. No data is copied, the views are plain offsets.
+    const size_t I=metadata.size();
+    columns.resize(I);
+    aligned_copies.resize(I);
+    for(std::vector<uint64_t> &copy:aligned_copies) copy.clear();
+    /// Every block is checked against the row count and the column width before anything is read from it
+    if(const char *error=chunk_layout_error(metadata,row_count,column_sizes)) THROW_GENERAL_ERROR(error);
+    size_t pos=0,k=0;
+    for(size_t i=0;i<I;i++)
+    {
+        column_view &view=columns[i];
+        if(metadata[i].nullable) view.null_offset=pos, pos+=column_sizes[k++];
+        if(metadata[i].is_true_varchar) view.length_offset=pos, pos+=column_sizes[k++];
+        view.data_offset=pos;
+        view.data_size=column_sizes[k];
+        pos+=column_sizes[k++];
+        if(pos>buffer.size()) THROW_GENERAL_ERROR("fetched buffer is smaller than reported column sizes");
+        view.value_offsets.clear();
+        if(metadata[i].is_true_varchar)
+        {
+            /// Null values do not occupy space in the data block
+            view.value_offsets.resize(row_count+1);
+            uint64_t shift=0;
+            for(size_t r=0;r<row_count;r++)
+            {
+                view.value_offsets[r]=shift;
+                if(metadata[i].nullable and buffer[view.null_offset+r]) continue;
+                int32_t size;
+                memcpy(&size,&buffer[view.length_offset+4*r],sizeof(size));
+                if(size<0) THROW_GENERAL_ERROR("fetched value length is negative");
+                shift+=size;
+            }
+            if(shift>view.data_size) THROW_GENERAL_ERROR("fetched value lengths exceed the data block");
+            view.value_offsets[row_count]=shift;
+        }
+    }
+}
+
+void sqream::result_batch::clear() {
+    /// <i>Drop the held chunk, keeping the allocation for the next fetch</i><br>
+    buffer.clear();
+    column_sizes.clear();
+    columns.clear();
+    aligned_copies.clear();
+    row_count=0;
+}
+
+const char *sqream::result_batch::null_block(const size_t col) const {
+    return buffer.data()+columns[col].null_offset;
+}
+
+const char *sqream::result_batch::length_block(const size_t col) const {
+    return buffer.data()+columns[col].length_offset;
+}
+
+const char *sqream::result_batch::data_block(const size_t col) const {
+    return buffer.data()+columns[col].data_offset;
+}
+
+const char *sqream::result_batch::aligned_data_block(const size_t col,const size_t alignment) {
+    /// <i>Data block of a column that can be read as an array of its type</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t col:&emsp; column index</li>
+    /// <li>const size_t alignment:&emsp; required alignment of the element type</li>
+    /// </ul>
+    /// Blocks are packed back to back on the wire, so a data block following an odd sized null block is misaligned.
+    /// Such blocks are copied once per chunk, all others are returned in place.
+    const char *data=data_block(col);
+    if(reinterpret_cast<uintptr_t>(data)%alignment==0) return data;
+    std::vector<uint64_t> &copy=aligned_copies[col];
+    if(copy.empty() and columns[col].data_size)
+    {
+        copy.resize((columns[col].data_size+sizeof(uint64_t)-1)/sizeof(uint64_t));
+        memcpy(copy.data(),data,columns[col].data_size);
+    }
+    return (const char*)copy.data();
+}
+
+
+//   ----  Prefetcher object
+//   -----------------------
+
+sqream::prefetcher::prefetcher() {
+    /// <i>Trivial prefetcher constructor</i><br>
+    sqc_=nullptr;
+    metadata_=nullptr;
+    depth_=0;
+    done_=true;
+    stop_=false;
+}
+
+sqream::prefetcher::~prefetcher() {
+    /// <i>Destructor that waits for a running fetch task</i><br>
+    try {
+        stop();
+    }
+    catch(std::string &err) {}
+}
+
+bool sqream::prefetcher::active() {
+    /// <b>return</b>(bool):&emsp; a fetch task was started and its chunks were not all read yet
+    return fetch_th!=nullptr;
+}
+
+void sqream::prefetcher::start(connector *sqc,const std::vector<column> &metadata,size_t depth) {
+    /// <i>Start a task that fetches and indexes select chunks while the previous ones are being read</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>connector *sqc:&emsp; connector of an executed select statement</li>
+    /// <li>const std::vector<column> &metadata:&emsp; output metadata of the statement</li>
+    /// <li>size_t depth:&emsp; maximum number of chunks kept ready ahead of the reader</li>
+    /// </ul>
+    /// The connector must not be used by anyone else until the task is stopped or its chunks are all read.
+    stop();
+    sqc_=sqc;
+    metadata_=&metadata;
+    depth_=depth;
+    done_=false;
+    stop_=false;
+    //The launch::async policy here is crucial to be sure it runs right away asynchronously instead of potentially being deferred
+    fetch_th.reset(new std::future<void>(std::async(std::launch::async,&sqream::prefetcher::run_,this)));
+}
+
+void sqream::prefetcher::run_() {
+    /// <i>Fetch chunks until the result set is exhausted, keeping at most depth_ of them unread</i><br>
+    auto finish=[this]() {
+        std::lock_guard<std::mutex> lock(mut_);
+        done_=true;
+        cv_.notify_all();
+    };
+    try {
+        while(true) {
+            result_batch batch;
+            {
+                std::unique_lock<std::mutex> lock(mut_);
+                cv_.wait(lock,[this]{ return stop_ or ready_.size()<depth_; });
+                if(stop_) break;
+                if(!spare_.empty()) {
+                    batch=std::move(spare_.back());
+                    spare_.pop_back();
+                }
+            }
+            batch.row_count=sqc_->fetch(batch.buffer,batch.column_sizes);
+            if(!batch.row_count) break;
+            batch.index(*metadata_);
+            std::lock_guard<std::mutex> lock(mut_);
+            ready_.push_back(std::move(batch));
+            cv_.notify_all();
+        }
+    }
+    catch(...) {
+        finish();
+        throw;
+    }
+    finish();
+}
+
+bool sqream::prefetcher::next(result_batch &batch) {
+    /// <i>Replace a read chunk with the next fetched one, waiting for it if needed</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>result_batch &batch:&emsp; read chunk, recycled for a later fetch</li>
+    /// </ul>
+    /// <b>return</b>(bool):&emsp; false when the result set is exhausted. Errors of the fetch task are rethrown here.
+    {
+        std::unique_lock<std::mutex> lock(mut_);
+        cv_.wait(lock,[this]{ return done_ or !ready_.empty(); });
+        if(!ready_.empty()) {
+            spare_.push_back(std::move(batch));
+            batch=std::move(ready_.front());
+            ready_.pop_front();
+            cv_.notify_all();
+            return true;
+        }
+    }
+    std::unique_ptr<std::future<void>> th=std::move(fetch_th);
+    batch.clear();
+    th->get();
+    return false;
+}
+
+void sqream::prefetcher::stop() {
+    /// <i>Make the fetch task end after its current fetch and drop the chunks it did not hand out</i><br>
+    if(!fetch_th) return;
+    {
+        std::lock_guard<std::mutex> lock(mut_);
+        stop_=true;
+        cv_.notify_all();
+    }
+    std::unique_ptr<std::future<void>> th=std::move(fetch_th);
+    try {
+        th->get();
+    }
+    catch(...) {
+        ready_.clear();
+        throw;
+    }
+    ready_.clear();
 }
 
-#undef ERR_HANDLE
-#undef ERR_HANDLE_STR
-
 
 //   ----  Driver object
 //   -------------------
@@ -484,8 +1458,22 @@ sqream::driver::driver() {
     /// <i>Trivial connector constructor</i><br>
     statement_type_=CONSTS::unset;
     sqc_=nullptr;
+    pool_=nullptr;
+    state_=0;
+    column_batch_rows_=0;
+    prefetch_depth_=0;
+    fetch_pipeline_=1;
+    fetch_window_=CONSTS::MAX_SIZE;
+    statement_cache_size_=0;
+    read_ahead_=CONSTS::READ_AHEAD;
+    ktls_=false;
+    io_backend_=CONSTS::blocking;
+    zerocopy_=false;
+    buff_count_=CONSTS::BUFF_COUNT;
+    put_budget_=UINT64_MAX;
+    queued_bytes_=0;
+    putting_=false;
     buffer_switch_th.reset(nullptr);
-    buffer_.reserve(CONSTS::MIN_PUT_SIZE);
 //*
 #ifndef __linux__
     sqc_->socket->SockInitLib();
@@ -496,26 +1484,30 @@ sqream::driver::driver() {
 sqream::driver::~driver()
 {
     /// <i>Destructor that closes a statement if available and disconnects from sqreamd</i><br>
-    if(buffer_switch_th) {
-        //std::printf("Ending previous buff switch\n");
-        (*buffer_switch_th).get();
-        buffer_switch_th.reset(nullptr);
+    /// Errors of the background tasks can be of any type and must not leave a destructor.
+    /// A checked out session goes back to its pool, which closes the open statement itself.
+    if(pool_) disconnect();
+    try {
+        prefetch_.stop();
+    }
+    catch(...) {}
+    try {
+        drain_puts_();
     }
-    if(state_>0 and state_<7 and sqc_->socket) {
+    catch(...) {}
+    if(state_>0 and state_<7 and sqc_ and sqc_->socket) {
+        try {
+            sqc_->drain_fetches();
+        }
+        catch(...) {}
         int bytes_read_write;
-        const size_t data_size=strlen(MESSAGES::closeStatement);
-        const size_t block_size=HEADER::SIZE+sizeof(data_size);
-        std::vector<char> pillow(block_size+data_size);
-        memcpy(pillow.data(),HEADER::HEADER_JSON,HEADER::SIZE);
-        memcpy(&pillow[HEADER::SIZE],&data_size,sizeof(data_size));
-        memcpy(&pillow[block_size],MESSAGES::closeStatement,data_size);
-        sqc_->socket->SockWriteChunk(pillow.data(),data_size+block_size,bytes_read_write);
+        sqc_->socket->SockWriteChunk(MESSAGES::closeStatement_frame.bytes,sizeof(MESSAGES::closeStatement_frame.bytes),bytes_read_write);
         char header[10];
         uint64_t data_size_out;
         sqc_->socket->SockReadChunk(header,bytes_read_write,sizeof(header));
         memcpy(&data_size_out,&header[2],sizeof(uint64_t));
-        std::vector<char> data(data_size);
-        sqc_->socket->SockReadChunk((char*)data.data(),bytes_read_write,data_size);
+        std::vector<char> data(data_size_out);
+        sqc_->socket->SockReadChunk((char*)data.data(),bytes_read_write,data_size_out);
     }
     disconnect();
 #ifndef __linux__
@@ -540,13 +1532,124 @@ bool sqream::driver::connect(const std::string &ipv4,int port,bool ssl,const std
     sqc_=new(std::nothrow) connector;
     if(!sqc_) 
         THROW_GENERAL_ERROR("error creating connection");
+    sqc_->set_fetch_pipeline(fetch_pipeline_,fetch_window_);
+    sqc_->set_statement_cache(statement_cache_size_);
+    sqc_->set_read_ahead(read_ahead_);
+    sqc_->set_ktls(ktls_);
+    sqc_->set_io_backend(io_backend_);
+    sqc_->set_zerocopy(zerocopy_);
 
     return sqc_->connect(ipv4,port,ssl,username,password,database,service);
 }
 
+void sqream::driver::set_prefetch_depth(const size_t depth) {
+    /// <i>Fetch select chunks in the background while the current one is read</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t depth:&emsp; number of chunks kept ready ahead of the reader, 0 fetches synchronously (default)</li>
+    /// </ul>
+    /// Takes effect on the next executed select. Each chunk held ahead costs its size in memory.
+    prefetch_depth_=depth;
+}
+
+void sqream::driver::set_fetch_pipeline(const uint32_t depth,const uint64_t window) {
+    /// <i>Keep several fetch requests in flight on the wire during selects</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const uint32_t depth:&emsp; maximum number of fetch requests in flight, 1 disables pipelining (default)</li>
+    /// <li>const uint64_t window:&emsp; cap on the expected bytes of the chunks in flight</li>
+    /// </ul>
+    /// Applies to the current connection and to the ones made later by connect().
+    if(!depth) THROW_GENERAL_ERROR("fetch pipeline depth must be at least 1");
+    fetch_pipeline_=depth;
+    fetch_window_=window;
+    if(sqc_) sqc_->set_fetch_pipeline(depth,window);
+}
+
+void sqream::driver::set_statement_cache(const size_t capacity) {
+    /// <i>Cache the type and metadata of recently executed selects and inserts by SQL text</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t capacity:&emsp; most statements cached per connection, 0 disables the cache (default)</li>
+    /// </ul>
+    /// Applies to the current connection and to the ones made later by connect(). See connector::set_statement_cache().
+    statement_cache_size_=capacity;
+    if(sqc_) sqc_->set_statement_cache(capacity);
+}
+
+void sqream::driver::set_read_ahead(const size_t bytes) {
+    /// <i>Size the buffer socket reads go through</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t bytes:&emsp; read-ahead buffer size, 0 reads straight from the socket (default CONSTS::READ_AHEAD)</li>
+    /// </ul>
+    /// Applies to the current connection and to the ones made later by connect(). See connector::set_read_ahead().
+    read_ahead_=bytes;
+    if(sqc_) sqc_->set_read_ahead(bytes);
+}
+
+void sqream::driver::set_ktls(const bool enable) {
+    /// <i>Use kernel TLS (Linux kTLS) on TLS connections made from now on</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const bool enable:&emsp; hand TLS record encryption to the kernel when it can take it (default false)</li>
+    /// </ul>
+    /// Takes effect on the next connect(). See connector::set_ktls().
+    ktls_=enable;
+    if(sqc_) sqc_->set_ktls(enable);
+}
+
+void sqream::driver::set_io_backend(const CONSTS::io_backend backend) {
+    /// <i>Pick how the sockets move bytes</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const CONSTS::io_backend backend:&emsp; CONSTS::blocking (default) or CONSTS::uring</li>
+    /// </ul>
+    /// Applies to the current connection and to the ones made later by connect(). See connector::set_io_backend().
+    io_backend_=backend;
+    if(sqc_) sqc_->set_io_backend(backend);
+}
+
+void sqream::driver::set_zerocopy(const bool enable) {
+    /// <i>Send the filled insert buffers with MSG_ZEROCOPY</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const bool enable:&emsp; zero copy sending of large puts (default false)</li>
+    /// </ul>
+    /// Applies to the current connection and to the ones made later by connect(). See connector::set_zerocopy().
+    zerocopy_=enable;
+    if(sqc_) sqc_->set_zerocopy(enable);
+}
+
+void sqream::driver::set_insert_buffers(const size_t count,const uint64_t budget) {
+    /// <i>Size the ring of buffers network insert rows are set into</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t count:&emsp; number of buffers, one is filled while the others wait to be sent or are being sent (default 2)</li>
+    /// <li>const uint64_t budget:&emsp; bytes the waiting buffers may hold before the setters block (default unbounded)</li>
+    /// </ul>
+    /// Takes effect on the next executed insert. Each buffer grows to about the min_put_size passed to next_query_row().
+    if(count<2) THROW_GENERAL_ERROR("at least 2 insert buffers are needed");
+    buff_count_=count;
+    put_budget_=budget;
+}
+
 void sqream::driver::disconnect() {
     /// <i>Disconnect from sqreamd</i><br>
+    /// A session checked out from a connection pool is given back to it instead of being closed
+    if(pool_) {
+        pool_->checkin(*this);
+        return;
+    }
     if(sqc_) {
+        try {
+            prefetch_.stop();
+        }
+        catch(...) {}
+        try {
+            drain_puts_();
+        }
+        catch(...) {}
         delete sqc_;
         sqc_=nullptr;
     }
@@ -560,6 +1663,8 @@ void sqream::driver::disconnect() {
 #define CI(X) if(X>=metadata_input_.size()) THROW_GENERAL_ERROR("input column does not exist in query");
 /// Standard error: thrown if a non existing column is getten
 #define CO(X) if(X>=metadata_output_.size()) THROW_GENERAL_ERROR("output column does not exist query");
+/// Standard error: thrown if chunk data is read before a chunk was fetched
+#define CF if(result_.columns.empty()) THROW_GENERAL_ERROR("no chunk fetched");
 /// Combinator of TC and CS macros
 #define TCCS(X,Y) TC(X) CS(Y)
 /// Combinator of TC, CS and CO macros
@@ -581,82 +1686,193 @@ void sqream::driver::init_pbuffer_(const std::vector<column> &metadata) {
     /// <ul>
     /// <li>std::vector<column> &metadata:&emsp; metadata vector</li>
     /// </ul>
-    for(size_t idx=0; idx < CONSTS::BUFF_COUNT; idx++) {
+    pbuffer_.resize(buff_count_);
+    for(size_t idx=0; idx < buff_count_; idx++) {
 
         pbuffer_[idx].clear();
         const size_t I = metadata.size();
         pbuffer_[idx].resize(I);
         for (size_t i = 0; i < I; i++) {
-            size_t blocks = 1;
-            if (metadata[i].nullable) blocks++;
-            if (metadata[i].is_true_varchar) blocks++;
-            pbuffer_[idx][i].resize(blocks);
-        }
-        blob_shift_[idx].resize(I);
-        for (size_t i = 0; i < I; i++) blob_shift_[idx][i].fill(0);
-    }
-}
-
-void sqream::driver::flatten_(std::vector<std::vector<std::vector<char>>> &buff_to_flatten) {
-    /// <i>Append unflat pbuffer to flat buffer</i><br>
-    for(std::vector<std::vector<char>> &cols:buff_to_flatten) for(std::vector<char> &col:cols) buffer_.insert(buffer_.end(),col.begin(),col.end());
-}
-
-void sqream::driver::unflatten_() {
-    /// <i>Append flat buffer to unflat pbuffer</i><br>
-    size_t pos=0,k=0;
-    const size_t I=pbuffer_[curr_buff_idx].size();
-    for(size_t i=0;i<I;i++)
-    {
-        const size_t J=pbuffer_[curr_buff_idx][i].size();
-        for(size_t j=0;j<J;j++)
-        {
-            const size_t size=column_sizes_[k++];
-            pbuffer_[curr_buff_idx][i][j].resize(size);
-            memcpy(pbuffer_[curr_buff_idx][i][j].data(),buffer_.data()+pos,size);
-            pos+=size;
+            pbuffer_[idx][i].resize(metadata[i].blocks);
         }
     }
 }
 
-void sqream::driver::reset_pbuffer_(const std::vector<column> &metadata) {
+void sqream::driver::reset_pbuffer_() {
     for(auto &cols:(pbuffer_[curr_buff_idx])) for(auto &col:cols) col.clear();
-
-    const size_t I=metadata.size();
-    blob_shift_[curr_buff_idx].clear();
-    blob_shift_[curr_buff_idx].resize(I);
-    for(size_t i=0;i<I;i++) blob_shift_[curr_buff_idx][i].fill(0);
 }
 
 void sqream::driver::put_buff(size_t row_cnt, int buff_idx) {
     std::unique_lock<std::mutex> lock(buff_switch_mut);
     //std::printf("Will switch from buffer '%d'\n", buff_idx);
-    flatten_(pbuffer_[buff_idx]);
-    sqc_->put(buffer_, row_cnt);
+    sqc_->put(pbuffer_[buff_idx], row_cnt);
     //std::printf("put(%ld)\n", ++put_cnt);
-    buffer_.clear();
 }
 
-void sqream::driver::new_query(const std::string &sql_query) {
-
-    /// <i>This function creates a new statement and deduces its type and metadata</i><br>
+void sqream::driver::queue_put_(size_t row_cnt) {
+    /// <i>Queue the current buffer for sending and make the next ring buffer current</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>size_t row_cnt:&emsp; number of rows in the current buffer</li>
+    /// </ul>
+    /// Blocks while every other buffer is still waiting or the waiting ones exceed the put budget.
+    std::unique_lock<std::mutex> lock(buff_switch_mut);
+    if(!put_error_.empty()) {
+        const std::string error=put_error_;
+        put_error_.clear();
+        throw error;
+    }
+    put_queue_.emplace_back(curr_buff_idx.load(),row_cnt);
+    queued_bytes_+=flat_size_();
+    if(!putting_) {
+        putting_=true;
+        //The launch::async policy here is crucial to be sure it runs right away asynchronously instead of potentially being deferred
+        buffer_switch_th.reset(new std::future<void>(std::async(std::launch::async,&sqream::driver::put_loop_,this)));
+    }
+    // the queue holds the buffers just before the current one, so the next one is free once the queue is shorter than the ring
+    buff_switch_cv.wait(lock,[this]{ return put_queue_.size()<pbuffer_.size() and queued_bytes_<=put_budget_; });
+    curr_buff_idx = (curr_buff_idx+1)%pbuffer_.size();
+}
+
+void sqream::driver::put_loop_() {
+    /// <i>Send the queued buffers in order until the queue is empty</i><br>
+    /// A failed put drops the buffers still queued, its error is raised by the next insert call.
+    std::unique_lock<std::mutex> lock(buff_switch_mut);
+    while(!put_queue_.empty()) {
+        const std::pair<int,size_t> next=put_queue_.front();
+        size_t bytes=0;
+        for(std::vector<std::vector<char>> &cols:pbuffer_[next.first]) for(std::vector<char> &col:cols) bytes+=col.size();
+        lock.unlock();
+        /// Any error is kept, one escaping the task would leave putting_ set and drain_puts_() waiting forever
+        std::string error;
+        bool failed=true;
+        try {
+            sqc_->put(pbuffer_[next.first],next.second);
+            failed=false;
+        }
+        catch(std::string &err) {
+            error=err;
+        }
+        catch(std::exception &err) {
+            error=err.what();
+        }
+        catch(...) {}
+        lock.lock();
+        if(failed) {
+            put_error_=error.empty() ? "put failed with an unknown error" : error;
+            put_queue_.clear();
+            queued_bytes_=0;
+            break;
+        }
+        put_queue_.pop_front();
+        queued_bytes_-=bytes;
+        buff_switch_cv.notify_all();
+    }
+    putting_=false;
+    buff_switch_cv.notify_all();
+}
+
+void sqream::driver::drain_puts_() {
+    /// <i>Wait until the put task has sent every queued buffer</i><br>
+    /// Raises the error of a failed put.
+    std::unique_lock<std::mutex> lock(buff_switch_mut);
+    buff_switch_cv.wait(lock,[this]{ return !putting_; });
+    lock.unlock();
+    if(buffer_switch_th) {
+        (*buffer_switch_th).get();
+        buffer_switch_th.reset(nullptr);
+    }
+    if(!put_error_.empty()) {
+        const std::string error=put_error_;
+        put_error_.clear();
+        throw error;
+    }
+}
+
+void sqream::driver::check_typed_columns_(CONSTS::statement_type type,const typed_column *expected,const size_t count) {
+    /// <i>Check once that the columns of the executed statement can be read or written as the types of a typed cursor or appender</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>CONSTS::statement_type type:&emsp; statement type the cursor or appender works on, its metadata is checked</li>
+    /// <li>const typed_column *expected:&emsp; expected type of every column, in column order</li>
+    /// <li>const size_t count:&emsp; number of expected columns</li>
+    /// </ul>
+    TCCS(sqc_,3)
+    if(statement_type_!=type) THROW_GENERAL_ERROR(type==CONSTS::select ? "typed cursors read select statements only" : "typed appenders write insert statements only");
+    const std::vector<column> &metadata=type==CONSTS::select ? metadata_output_ : metadata_input_;
+    if(metadata.size()!=count) THROW_GENERAL_ERROR("statement has "+std::to_string(metadata.size())+" columns, not "+std::to_string(count));
+    for(size_t col=0;col<count;col++) {
+        if(metadata[col].type_code!=expected[col].type and (expected[col].alt_type==CONSTS::ftUnknown or metadata[col].type_code!=expected[col].alt_type))
+            THROW_GENERAL_ERROR("column "+std::to_string(col)+" is of type "+metadata[col].type+", not "+expected[col].name);
+        if(metadata[col].nullable and !expected[col].optional)
+            THROW_GENERAL_ERROR("column "+std::to_string(col)+" is nullable, its type must be a std::optional");
+        if(type==CONSTS::insert and !metadata[col].nullable and expected[col].optional)
+            THROW_GENERAL_ERROR("column "+std::to_string(col)+" is not nullable, its type can not be a std::optional");
+    }
+}
+
+void sqream::driver::new_query(const std::string &sql_query) {
+
+    /// <i>This function creates a new statement and deduces its type and metadata</i><br>
     /// <b>input:</b>
     /// <ul>
     /// <li>const std::string &sql_query:&emsp; SQream SQL Query</li>
     /// </ul>
     TC(sqc_)
+    init_statement_();
+    if(!sqc_->open_prepare_statement(sql_query,57/*Grothendieck prime*/)) THROW_GENERAL_ERROR("error preparing statement");
+    state_|=1;
+
+}
+
+void sqream::driver::init_statement_() {
+    /// <i>Reset the driver state left by the previous statement</i><br>
+    /// A select abandoned before its end is dropped, so the error of its background fetch is not reported.
+    try {
+        prefetch_.stop();
+    }
+    catch(...) {}
+    /// Rows of an unfinished insert that failed to be sent are reported once the driver state is reset
+    std::string put_error;
+    try {
+        drain_puts_();
+    }
+    catch(std::string &err) {
+        put_error=err;
+    }
     state_=0;
     row_count_=0;
     current_row_=0;
     curr_buff_idx = 0;
 
-    buffer_.clear();
-    column_sizes_.clear();
+    result_.clear();
     colck_.clear();
-    sqc_->open_statement();
-    if(!sqc_->prepare_statement(sql_query,57/*Grothendieck prime*/)) THROW_GENERAL_ERROR("error preparing statement");
-    state_|=1;
+    column_batch_rows_=0;
+    column_names_.clear();
+    if(!put_error.empty()) throw put_error;
+}
 
+void sqream::driver::init_buffers_() {
+    /// <i>Prepare the insert buffers or start the select prefetch once the statement type is known</i><br>
+    switch(statement_type_) {
+        case CONSTS::insert: {
+            init_pbuffer_(metadata_input_);
+            colck_.resize(metadata_input_.size(),0);
+        }
+        break;
+        case CONSTS::select: {
+            result_.clear();
+            if(prefetch_depth_) prefetch_.start(sqc_,metadata_output_,prefetch_depth_);
+        }
+        break;
+        default: break;
+    }
+    /// Named access hashes the column names once per statement, the first of duplicate names wins as a scan would.
+    /// Insert columns stay unnamed without a column list in the statement, they can't be found by name.
+    const std::vector<column> &metadata=statement_type_==CONSTS::insert ? metadata_input_ : metadata_output_;
+    column_names_.clear();
+    column_names_.reserve(metadata.size());
+    for(size_t i=0;i<metadata.size();i++) if(!metadata[i].name.empty()) column_names_.emplace(metadata[i].name,i);
 }
 
 bool sqream::driver::execute_query() {
@@ -667,23 +1883,26 @@ bool sqream::driver::execute_query() {
     /// <li>const std::string &sql_query:&emsp; SQream SQL Query</li>
     /// </ul>
     TCCS(sqc_,1)
-    if(sqc_->execute()) {
-        statement_type_=sqc_->metadata_query(metadata_input_,metadata_output_);
-        
-        switch(statement_type_) {
-            case CONSTS::insert: {
-                init_pbuffer_(metadata_input_);
-                colck_.resize(metadata_input_.size(),0);
-            }
-            break;
-            case CONSTS::select: init_pbuffer_(metadata_output_); break;
-            default: break;
-        }
-        state_|=2;
-        return true;
-    }
-    else 
-        THROW_GENERAL_ERROR("failed to execute query");
+    statement_type_=sqc_->execute_metadata_query(metadata_input_,metadata_output_);
+    init_buffers_();
+    state_|=2;
+    return true;
+}
+
+bool sqream::driver::new_execute_query(const std::string &sql_query) {
+    /// <i>This function creates a new statement and starts executing it, pipelining the whole setup in a single round trip</i><br>
+    /// It is equivalent to new_query() followed by execute_query()<br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const std::string &sql_query:&emsp; SQream SQL Query</li>
+    /// </ul>
+    TC(sqc_)
+    init_statement_();
+    statement_type_=sqc_->open_prepare_execute(sql_query,57/*Grothendieck prime*/,metadata_input_,metadata_output_);
+    state_|=1;
+    init_buffers_();
+    state_|=2;
+    return true;
 }
 
 
@@ -699,50 +1918,13 @@ bool sqream::driver::next_query_row(const size_t min_put_size) {
     switch(statement_type_) {
         case CONSTS::insert:
         {
-            size_t sum=0;
-            for(uint8_t p:colck_) if(p>0) sum++;
-            if(sum!=metadata_input_.size()) THROW_GENERAL_ERROR("some columns are unitialized");
-            for(uint8_t &p:colck_) p=0;
-            if(flat_size_()>=min_put_size)
-            {
-                if(buffer_switch_th)
-                {
-                    //std::printf("Ending previous buff switch\n");
-                    (*buffer_switch_th).get();
-                    buffer_switch_th.reset(nullptr);
-                }
-
-                //The launch::async policy here is crucial to be sure it runs right away asynchronously instead of potentially being deferred
-                buffer_switch_th.reset(new std::future<void>(std::async(std::launch::async,&sqream::driver::put_buff, this, ++row_count_, curr_buff_idx.load())));
-                curr_buff_idx = (curr_buff_idx+1)%CONSTS::BUFF_COUNT;
-
-                reset_pbuffer_(metadata_input_);
-                row_count_=0;
-            }
-            else row_count_++;
+            advance_insert_(1,1,min_put_size);
             return true;
         }
         case CONSTS::select:
         {
             if(++current_row_<row_count_) return true;
-            else
-            {
-                column_sizes_.clear();
-                row_count_=sqc_->fetch(buffer_,column_sizes_);
-                if(row_count_)
-                {
-                    current_row_=0;
-                    init_pbuffer_(metadata_output_);
-                    unflatten_();
-                    buffer_.clear();
-                    return true;
-                }
-                else
-                {
-                    state_|=4;
-                    return false;
-                }
-            }
+            else return fetch_chunk_();
         }
         default:
         {
@@ -752,22 +1934,102 @@ bool sqream::driver::next_query_row(const size_t min_put_size) {
     }
 }
 
+bool sqream::driver::next_query_rows(const size_t min_put_size) {
+
+    /// <i>This driver sends the batch of rows set by the set_*_column functions</i><br>
+    /// This function can only be executed after a execute_query() call on an insert statement<br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t &min_put_size:&emsp; minimal size of the binary data black to be sent</li>
+    /// </ul>
+    TCCS(sqc_,3)
+    if(statement_type_!=CONSTS::insert) THROW_GENERAL_ERROR("column batches can only be set for insert statements");
+    advance_insert_(2,column_batch_rows_,min_put_size);
+    column_batch_rows_=0;
+    return true;
+}
+
+void sqream::driver::advance_insert_(const uint8_t set_by,const size_t rows,const size_t min_put_size) {
+    /// <i>Account for rows whose columns are all set and hand the buffer over to the put thread once it is large enough</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const uint8_t set_by:&emsp; colck_ mark every column must carry, 1 for row setters and 2 for column setters</li>
+    /// <li>const size_t rows:&emsp; number of rows that were set</li>
+    /// <li>const size_t &min_put_size:&emsp; minimal size of the binary data black to be sent</li>
+    /// </ul>
+    for(uint8_t p:colck_)
+    {
+        if(!p) THROW_GENERAL_ERROR("some columns are unitialized");
+        if(p!=set_by) THROW_GENERAL_ERROR("row and column setters can not be mixed in one row");
+    }
+    for(uint8_t &p:colck_) p=0;
+    row_count_+=rows;
+    if(flat_size_()>=min_put_size) flush_insert_();
+}
+
+void sqream::driver::flush_insert_() {
+    /// <i>Queue the rows of the current insert buffer for sending and start the next buffer</i><br>
+    queue_put_(row_count_);
+    reset_pbuffer_();
+    row_count_=0;
+}
+
+bool sqream::driver::fetch_chunk_() {
+    /// <i>Fetch the next chunk of a select and point the getters at its first row</i><br>
+    /// <b>return</b>(bool):&emsp; false when the result set is exhausted
+    bool fetched;
+    if(prefetch_.active()) fetched=prefetch_.next(result_);
+    else {
+        result_.row_count=sqc_->fetch(result_.buffer,result_.column_sizes);
+        fetched=result_.row_count>0;
+        if(fetched) result_.index(metadata_output_);
+    }
+    row_count_=result_.row_count;
+    if(fetched)
+    {
+        current_row_=0;
+        return true;
+    }
+    else
+    {
+        state_|=4;
+        return false;
+    }
+}
+
+bool sqream::driver::next_query_chunk() {
+    /// <i>Skip the remaining rows of the current chunk and fetch the next one</i><br>
+    /// This function can only be executed after a execute_query() call on a select statement.
+    /// Rows of the new chunk are read at once with the get_*_column functions.<br>
+    /// <b>return</b>(bool):&emsp; false when the result set is exhausted
+    TCCS(sqc_,3)
+    if(statement_type_!=CONSTS::select) THROW_GENERAL_ERROR("chunks can only be fetched for select statements");
+    return fetch_chunk_();
+}
+
 bool sqream::driver::finish_query() {
     /// <i>This driver retrieves or sends data per row</i><br>
     /// This function can only be executed after a execute_query() call
     if(state_==3) state_|=4;
     TCCS(sqc_,7)
-    if(statement_type_==CONSTS::insert) {
-        if(buffer_switch_th) {
-            //std::printf("Ending previous buff switch\n");
-            (*buffer_switch_th).get();
-            buffer_switch_th.reset(nullptr);
+    try {
+        if(statement_type_==CONSTS::insert) {
+            drain_puts_();
+            if(flat_size_()) {
+                put_buff(row_count_, curr_buff_idx.load());
+            }
         }
-        if(flat_size_()) {
-            put_buff(row_count_, curr_buff_idx.load());
+        prefetch_.stop();
+    }
+    catch(...) {
+        /// A failed put or background fetch still closes the statement on sqreamd before its error is reported
+        state_|=8;
+        try {
+            sqc_->close_statement();
         }
+        catch(...) {}
+        throw;
     }
-
     state_|=8;
     return sqc_->close_statement();
 }
@@ -780,15 +2042,10 @@ bool sqream::driver::is_null(const size_t col)
     /// <li>const size_t &col:&emsp; column index</li>
     /// </ul>
     /// <b>return</b>(bool):&emsp; value
-    TCCSCO(sqc_,3,col)
+    TCCSCO(sqc_,3,col) CF
     if(!is_nullable(col)) THROW_GENERAL_ERROR("column is not nullable");
     bool retval;
-    memcpy(&retval,pbuffer_[curr_buff_idx][col][0].data()+current_row_,sizeof(retval));
-    if(metadata_output_[col].type == "ftBlob" && retval == true)
-    {
-        const size_t idx=current_row_%2;
-        blob_shift_[curr_buff_idx][col][1-idx]=blob_shift_[curr_buff_idx][col][idx];
-    }
+    memcpy(&retval,result_.null_block(col)+current_row_,sizeof(retval));
     return retval;
 }
 
@@ -828,12 +2085,11 @@ bool sqream::driver::is_nullable(const size_t col)
 */
 #define GET_FIXED_TYPES(X,Y,Z)\
 {\
-    TCCSCO(sqc_,3,col)\
-    if(metadata_output_[col].type!=#X) THROW_GENERAL_ERROR("column is not of type "#Y);\
-    const size_t id=metadata_output_[col].nullable?1:0;\
+    TCCSCO(sqc_,3,col) CF\
+    if(metadata_output_[col].type_code!=CONSTS::X) THROW_GENERAL_ERROR("column is not of type "#Y);\
     const size_t shift=metadata_output_[col].size*current_row_;\
     Z retval;\
-    memcpy(&retval,pbuffer_[curr_buff_idx][col][id].data()+shift,sizeof(retval));\
+    memcpy(&retval,result_.data_block(col)+shift,sizeof(retval));\
     return retval;\
 }
 bool sqream::driver::get_bool(const size_t col) GET_FIXED_TYPES(ftBool,bool,bool)
@@ -909,15 +2165,7 @@ std::string sqream::driver::get_varchar(const size_t col)
     /// <li>const size_t &col:&emsp; column index</li>
     /// </ul>
     /// <b>return</b>(std::string):&emsp; value
-    TCCSCO(sqc_,3,col)
-    if(metadata_output_[col].type!="ftVarchar") THROW_GENERAL_ERROR("column is not of type varchar");
-    const size_t id=metadata_output_[col].nullable?1:0;
-    const size_t size=metadata_output_[col].size;
-    const size_t shift=metadata_output_[col].size*current_row_;
-    std::string retval;
-    retval.resize(size);
-    memcpy(const_cast<char*>(retval.data()),pbuffer_[curr_buff_idx][col][id].data()+shift,size);
-    return retval;
+    return std::string(get_varchar_view(col));
 }
 
 std::string sqream::driver::get_nvarchar(const size_t col)
@@ -928,20 +2176,147 @@ std::string sqream::driver::get_nvarchar(const size_t col)
     /// <li>const size_t &col:&emsp; column index</li>
     /// </ul>
     /// <b>return</b>(std::string):&emsp; value
-    TCCSCO(sqc_,3,col)
-    if(metadata_output_[col].type!="ftBlob") THROW_GENERAL_ERROR("column is not of type nvarchar");
-    const size_t ids=metadata_output_[col].nullable?1:0;
-    const size_t idn=ids+1;
-    const size_t shift=4*current_row_;
-    const size_t idx=current_row_%2;
-    int nvarchar_size_container;
-    memcpy(&nvarchar_size_container,pbuffer_[curr_buff_idx][col][ids].data()+shift,sizeof(nvarchar_size_container));
-    std::string retval;
-    retval.resize(nvarchar_size_container);
-    memcpy(const_cast<char*>(retval.data()),pbuffer_[curr_buff_idx][col][idn].data()+blob_shift_[curr_buff_idx][col][idx],nvarchar_size_container);
-    blob_shift_[curr_buff_idx][col][1-idx]=blob_shift_[curr_buff_idx][col][idx]+nvarchar_size_container;
-    return retval;
+    return std::string(get_nvarchar_view(col));
+}
+
+std::string_view sqream::driver::get_varchar_view(const size_t col,const bool trim)
+{
+    /// <i>retrieve a varchar type value from a column by index without copying it</i><br>
+    /// The view points into the fetched chunk and is valid until the next chunk is fetched<br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t &col:&emsp; column index</li>
+    /// <li>const bool &trim:&emsp; drop the trailing spaces padding the value to the column size</li>
+    /// </ul>
+    /// <b>return</b>(std::string_view):&emsp; value
+    TCCSCO(sqc_,3,col) CF
+    if(metadata_output_[col].type_code!=CONSTS::ftVarchar) THROW_GENERAL_ERROR("column is not of type varchar");
+    const size_t size=metadata_output_[col].size;
+    const char * const ptr=result_.data_block(col)+size*current_row_;
+    size_t length=size;
+    if(trim) while(length and ptr[length-1]==' ') length--;
+    return std::string_view(ptr,length);
+}
+
+std::string_view sqream::driver::get_nvarchar_view(const size_t col)
+{
+    /// <i>retrieve a nvarchar type value from a column by index without copying it</i><br>
+    /// The view points into the fetched chunk and is valid until the next chunk is fetched<br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t &col:&emsp; column index</li>
+    /// </ul>
+    /// <b>return</b>(std::string_view):&emsp; value
+    TCCSCO(sqc_,3,col) CF
+    if(metadata_output_[col].type_code!=CONSTS::ftBlob) THROW_GENERAL_ERROR("column is not of type nvarchar");
+    const std::vector<uint64_t> &offsets=result_.columns[col].value_offsets;
+    return std::string_view(result_.data_block(col)+offsets[current_row_],offsets[current_row_+1]-offsets[current_row_]);
+}
+
+size_t sqream::driver::get_chunk_rows()
+{
+    /// <i>retrieve the number of rows held by the current fetched chunk</i><br>
+    /// <b>return</b>(size_t):&emsp; row count
+    TCCS(sqc_,3)
+    if(statement_type_!=CONSTS::select) THROW_GENERAL_ERROR("chunks can only be fetched for select statements");
+    CF
+    return row_count_;
+}
+
+std::span<const bool> sqream::driver::get_null_column(const size_t col)
+{
+    /// <i>retrieve the null flags of a column for every row of the current chunk</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t &col:&emsp; column index</li>
+    /// </ul>
+    /// <b>return</b>(std::span<const bool>):&emsp; null flags, valid until the next chunk is fetched
+    TCCSCO(sqc_,3,col) CF
+    if(!metadata_output_[col].nullable) THROW_GENERAL_ERROR("column is not nullable");
+    return std::span<const bool>((const bool*)result_.null_block(col),row_count_);
+}
+
+/*!
+\def GET_COLUMN_TYPES(X,Y,Z)
+<i>This macro implements all <b>get</b> functions returning a whole chunk of a fixed type column</i>
+<b>input:</b>
+<ul>
+<li>\a X:&emsp; SQream type name</li>
+<li>\a Y:&emsp; THROW type name</li>
+<li>\a Z:&emsp; C++ type name</li>
+</ul>
+The returned span is valid until the next chunk is fetched. Values of null rows are unspecified.
+*/
+#define GET_COLUMN_TYPES(X,Y,Z)\
+{\
+    TCCSCO(sqc_,3,col) CF\
+    if(metadata_output_[col].type_code!=CONSTS::X) THROW_GENERAL_ERROR("column is not of type "#Y);\
+    return std::span<const Z>((const Z*)result_.aligned_data_block(col,alignof(Z)),row_count_);\
 }
+std::span<const bool> sqream::driver::get_bool_column(const size_t col) GET_COLUMN_TYPES(ftBool,bool,bool)
+///< <i>retrieve boolean type values of the current chunk from a column by index</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< </ul>
+///< <b>return</b>(std::span<const bool>):&emsp; values
+std::span<const uint8_t> sqream::driver::get_ubyte_column(const size_t col) GET_COLUMN_TYPES(ftUByte,UByte,uint8_t)
+///< <i>retrieve unsigned byte type values of the current chunk from a column by index</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< </ul>
+///< <b>return</b>(std::span<const uint8_t>):&emsp; values
+std::span<const int16_t> sqream::driver::get_short_column(const size_t col) GET_COLUMN_TYPES(ftShort,short,int16_t)
+///< <i>retrieve short type values of the current chunk from a column by index</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< </ul>
+///< <b>return</b>(std::span<const int16_t>):&emsp; values
+std::span<const int32_t> sqream::driver::get_int_column(const size_t col) GET_COLUMN_TYPES(ftInt,int,int32_t)
+///< <i>retrieve int type values of the current chunk from a column by index</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< </ul>
+///< <b>return</b>(std::span<const int32_t>):&emsp; values
+std::span<const int64_t> sqream::driver::get_long_column(const size_t col) GET_COLUMN_TYPES(ftLong,long,int64_t)
+///< <i>retrieve long type values of the current chunk from a column by index</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< </ul>
+///< <b>return</b>(std::span<const int64_t>):&emsp; values
+std::span<const float> sqream::driver::get_float_column(const size_t col) GET_COLUMN_TYPES(ftFloat,float,float)
+///< <i>retrieve float type values of the current chunk from a column by index</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< </ul>
+///< <b>return</b>(std::span<const float>):&emsp; values
+std::span<const double> sqream::driver::get_double_column(const size_t col) GET_COLUMN_TYPES(ftDouble,double,double)
+///< <i>retrieve double type values of the current chunk from a column by index</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< </ul>
+///< <b>return</b>(std::span<const double>):&emsp; values
+std::span<const uint32_t> sqream::driver::get_date_column(const size_t col) GET_COLUMN_TYPES(ftDate,date,uint32_t)
+///< <i>retrieve date type values of the current chunk from a column by index</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< </ul>
+///< <b>return</b>(std::span<const uint32_t>):&emsp; values
+std::span<const uint64_t> sqream::driver::get_datetime_column(const size_t col) GET_COLUMN_TYPES(ftDateTime,datetime,uint64_t)
+///< <i>retrieve datetime type values of the current chunk from a column by index</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< </ul>
+///< <b>return</b>(std::span<const uint64_t>):&emsp; values
+#undef GET_COLUMN_TYPES
 
 /*!
 \def NAMED_GETS(X)
@@ -953,9 +2328,22 @@ std::string sqream::driver::get_nvarchar(const size_t col)
 */
 #define NAMED_GETS(X)\
 {\
-    const size_t I=metadata_output_.size();\
-    for(size_t i=0;i<I;i++) if(metadata_output_[i].name==col_name) return X(i);\
-    THROW_GENERAL_ERROR("column name not found");\
+    return X(get_column_index(col_name));\
+}
+
+size_t sqream::driver::get_column_index(const std::string &col_name) {
+    /// <i>Resolve a column name of the executed statement to its index</i><br>
+    /// The index stays valid for the whole statement, so it can be resolved once and used with the index
+    /// getters and setters in row loops instead of hashing the name on every call<br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const std::string &col_name:&emsp; column name</li>
+    /// </ul>
+    /// <b>return</b>(size_t):&emsp; column index
+    TCCS(sqc_,3)
+    const auto found=column_names_.find(col_name);
+    if(found==column_names_.end()) THROW_GENERAL_ERROR("column name not found");
+    return found->second;
 }
 
 bool sqream::driver::is_nullable(const std::string &col_name) NAMED_GETS(is_nullable)
@@ -1060,7 +2448,8 @@ else THROW_GENERAL_ERROR("column already set");\
 {\
     const bool whiper=false;\
     const char * const wptr=(char*)&whiper;\
-    pbuffer_[curr_buff_idx][col][0].insert(pbuffer_[curr_buff_idx][col][0].end(),wptr,wptr+sizeof(whiper));\
+    std::vector<char> &nblock=pbuffer_[curr_buff_idx][col][metadata_input_[col].null_block];\
+    nblock.insert(nblock.end(),wptr,wptr+sizeof(whiper));\
 }
 
 void sqream::driver::set_null(const size_t col)
@@ -1074,11 +2463,11 @@ void sqream::driver::set_null(const size_t col)
     TCCSCI(sqc_,3,col)
     if(!is_nullable(col)) THROW_GENERAL_ERROR("column is not nullable");
     COLCK
-    const bool value=true;
-    const char * const ptr=(char*)&value;
-    pbuffer_[curr_buff_idx][col][0].insert(pbuffer_[curr_buff_idx][col][0].end(),ptr,ptr+sizeof(value));
-    std::vector<char> whiper(metadata_input_[col].is_true_varchar?4:metadata_input_[col].size,metadata_input_[col].name=="ftVarchar"?32:0);
-    pbuffer_[curr_buff_idx][col][1].insert(pbuffer_[curr_buff_idx][col][1].end(),whiper.begin(),whiper.end());
+    const column &c=metadata_input_[col];
+    pbuffer_[curr_buff_idx][col][c.null_block].push_back(true);
+    /// <i>a null true varchar gets an empty value, other types a placeholder of their size</i><br>
+    std::vector<char> &block=pbuffer_[curr_buff_idx][col][c.is_true_varchar?c.length_block:c.data_block];
+    block.insert(block.end(),c.is_true_varchar?sizeof(int32_t):c.size,c.type_code==CONSTS::ftVarchar?' ':0);
 }
 
 /*!
@@ -1093,9 +2482,9 @@ void sqream::driver::set_null(const size_t col)
 #define SET_FIXED_TYPES(X,Y)\
 {\
     TCCSCI(sqc_,3,col)\
-    if(metadata_input_[col].type!=#X) THROW_GENERAL_ERROR("column is not of type "#Y);\
+    if(metadata_input_[col].type_code!=CONSTS::X) THROW_GENERAL_ERROR("column is not of type "#Y);\
     COLCK \
-    const size_t id=metadata_input_[col].nullable?1:0;\
+    const size_t id=metadata_input_[col].data_block;\
     const char * const ptr=(char*)&value;\
     pbuffer_[curr_buff_idx][col][id].insert(pbuffer_[curr_buff_idx][col][id].end(),ptr,ptr+sizeof(value));\
     NULL_WHIPER\
@@ -1174,10 +2563,10 @@ void sqream::driver::set_varchar(const size_t col,const std::string &value)
     ///< <li>const std::string &value:&emsp; value</li>
     ///< </ul>
     TCCSCI(sqc_,3,col)
-    if(metadata_input_[col].type!="ftVarchar") THROW_GENERAL_ERROR("column is not of type varchar");
+    if(metadata_input_[col].type_code!=CONSTS::ftVarchar) THROW_GENERAL_ERROR("column is not of type varchar");
     if(metadata_input_[col].size<value.size()) THROW_GENERAL_ERROR("string size is bigger than column varchar size");
     COLCK
-    const size_t id=metadata_input_[col].nullable?1:0;
+    const size_t id=metadata_input_[col].data_block;
     const char * const ptr=value.c_str();
     pbuffer_[curr_buff_idx][col][id].insert(pbuffer_[curr_buff_idx][col][id].end(),ptr,ptr+value.size());
     std::vector<char> spaces(metadata_input_[col].size-value.size(),' ');
@@ -1194,10 +2583,10 @@ void sqream::driver::set_nvarchar(const size_t col,const std::string &value)
     ///< <li>const std::string &value:&emsp; value</li>
     ///< </ul>
     TCCSCI(sqc_,3,col)
-    if(metadata_input_[col].type!="ftBlob" and !metadata_input_[col].is_true_varchar) THROW_GENERAL_ERROR("column is not of type nvarchar");
+    if(metadata_input_[col].type_code!=CONSTS::ftBlob and !metadata_input_[col].is_true_varchar) THROW_GENERAL_ERROR("column is not of type nvarchar");
     COLCK
-    const size_t ids=metadata_input_[col].nullable?1:0;
-    const size_t idn=ids+1;
+    const size_t ids=metadata_input_[col].length_block;
+    const size_t idn=metadata_input_[col].data_block;
     const int nvarchar_size_container=value.size();
     const char * const size_ptr=(const char *)&nvarchar_size_container;
     pbuffer_[curr_buff_idx][col][ids].insert(pbuffer_[curr_buff_idx][col][ids].end(),size_ptr,size_ptr+sizeof(nvarchar_size_container));
@@ -1206,117 +2595,289 @@ void sqream::driver::set_nvarchar(const size_t col,const std::string &value)
     NULL_WHIPER
 }
 
-void sqream::driver::set_null(const std::string &col_name)
-{
-    /// <i>nullify value of a column by name</i><br>
-    /// <b>input:</b>
-    /// <ul>
-    /// <li>const size_t &col:&emsp; column index</li>
-    /// <li>const bool &col:&emsp; value</li>
-    /// </ul>
-    (void) col_name;
-    THROW_GENERAL_ERROR("setting for named columns is currently not supported");
+/// Macro to check a column batch is consistent with the ones already set for the pending rows
+#define COLUMN_COLCK(N) if(colck_[col]) THROW_GENERAL_ERROR("column already set");\
+if(!N) THROW_GENERAL_ERROR("column batch is empty");\
+if(column_batch_rows_ and column_batch_rows_!=N) THROW_GENERAL_ERROR("column batch size differs from other columns");\
+if(!nulls.empty() and nulls.size()!=N) THROW_GENERAL_ERROR("null flags size differs from column batch size");\
+if(!nulls.empty() and !metadata_input_[col].nullable) THROW_GENERAL_ERROR("column is not nullable");\
+colck_[col]=2;\
+column_batch_rows_=N;
+
+/// Macro to append the null flags of a column batch to the NULL column if present
+#define NULL_COLUMN_WHIPER if(metadata_input_[col].nullable)\
+{\
+    std::vector<char> &nblock=pbuffer_[curr_buff_idx][col][metadata_input_[col].null_block];\
+    if(nulls.empty()) nblock.insert(nblock.end(),values.size(),0);\
+    else nblock.insert(nblock.end(),(const char*)nulls.data(),(const char*)nulls.data()+nulls.size_bytes());\
 }
 
 /*!
-\def NAMED_SETS
-<i>This macro implements all <b>set</b> calls by column name</i>
+\def SET_COLUMN_TYPES(X,Y)
+<i>This macro implements all <b>set</b> functions appending a batch of rows to a fixed type column</i>
+<b>input:</b>
+<ul>
+<li>\a X:&emsp; SQream type name</li>
+<li>\a Y:&emsp; THROW type name</li>
+</ul>
+Values of null rows are sent as given and ignored by sqreamd.
 */
-#define NAMED_SETS \
+#define SET_COLUMN_TYPES(X,Y)\
 {\
-    (void) col_name;\
-    (void) value;\
-    THROW_GENERAL_ERROR("setting for named columns is currently not supported");\
+    TCCSCI(sqc_,3,col)\
+    if(metadata_input_[col].type_code!=CONSTS::X) THROW_GENERAL_ERROR("column is not of type "#Y);\
+    COLUMN_COLCK(values.size())\
+    const size_t id=metadata_input_[col].data_block;\
+    const char * const ptr=(const char*)values.data();\
+    pbuffer_[curr_buff_idx][col][id].insert(pbuffer_[curr_buff_idx][col][id].end(),ptr,ptr+values.size_bytes());\
+    NULL_COLUMN_WHIPER\
 }
-void sqream::driver::set_bool(const std::string &col_name,const bool value) NAMED_SETS
-///< <i>set a bool type value of a column by name</i><br>
-///< <b>input:</b>
-///< <ul>
-///< <li>const size_t &col:&emsp; column index</li>
-///< <li>const bool &value:&emsp; value</li>
-///< </ul>
-void sqream::driver::set_ubyte(const std::string &col_name,const uint8_t value) NAMED_SETS
-///< <i>set a unsigned byte type value of a column by name</i><br>
-///< <b>input:</b>
-///< <ul>
-///< <li>const size_t &col:&emsp; column index</li>
-///< <li>const uint8_t &value:&emsp; value</li>
-///< </ul>
-void sqream::driver::set_short(const std::string &col_name,const uint16_t value) NAMED_SETS
-///< <i>set a short type value of a column by name</i><br>
+void sqream::driver::set_bool_column(const size_t col,std::span<const bool> values,std::span<const bool> nulls) SET_COLUMN_TYPES(ftBool,bool)
+///< <i>set bool type values of a batch of rows of a column by index</i><br>
 ///< <b>input:</b>
 ///< <ul>
 ///< <li>const size_t &col:&emsp; column index</li>
-///< <li>const int16_t &value:&emsp; value</li>
+///< <li>std::span<const bool> values:&emsp; values</li>
+///< <li>std::span<const bool> nulls:&emsp; null flags (optional)</li>
 ///< </ul>
-void sqream::driver::set_int(const std::string &col_name,const uint32_t value) NAMED_SETS
-///< <i>set a int type value of a column by name</i><br>
+void sqream::driver::set_ubyte_column(const size_t col,std::span<const uint8_t> values,std::span<const bool> nulls) SET_COLUMN_TYPES(ftUByte,UByte)
+///< <i>set unsigned byte type values of a batch of rows of a column by index</i><br>
 ///< <b>input:</b>
 ///< <ul>
 ///< <li>const size_t &col:&emsp; column index</li>
-///< <li>const int32_t &value:&emsp; value</li>
+///< <li>std::span<const uint8_t> values:&emsp; values</li>
+///< <li>std::span<const bool> nulls:&emsp; null flags (optional)</li>
 ///< </ul>
-void sqream::driver::set_long(const std::string &col_name,const uint64_t value) NAMED_SETS
-///< <i>set a long type value of a column by name</i><br>
+void sqream::driver::set_short_column(const size_t col,std::span<const int16_t> values,std::span<const bool> nulls) SET_COLUMN_TYPES(ftShort,short)
+///< <i>set short type values of a batch of rows of a column by index</i><br>
 ///< <b>input:</b>
 ///< <ul>
 ///< <li>const size_t &col:&emsp; column index</li>
-///< <li>const int64_t &value:&emsp; value</li>
+///< <li>std::span<const int16_t> values:&emsp; values</li>
+///< <li>std::span<const bool> nulls:&emsp; null flags (optional)</li>
 ///< </ul>
-void sqream::driver::set_float(const std::string &col_name,const float value) NAMED_SETS
-///< <i>set a float type value of a column by name</i><br>
+void sqream::driver::set_int_column(const size_t col,std::span<const int32_t> values,std::span<const bool> nulls) SET_COLUMN_TYPES(ftInt,int)
+///< <i>set int type values of a batch of rows of a column by index</i><br>
 ///< <b>input:</b>
 ///< <ul>
 ///< <li>const size_t &col:&emsp; column index</li>
-///< <li>const float &value:&emsp; value</li>
+///< <li>std::span<const int32_t> values:&emsp; values</li>
+///< <li>std::span<const bool> nulls:&emsp; null flags (optional)</li>
 ///< </ul>
-void sqream::driver::set_double(const std::string &col_name,const double value) NAMED_SETS
-///< <i>set a double type value of a column by name</i><br>
+void sqream::driver::set_long_column(const size_t col,std::span<const int64_t> values,std::span<const bool> nulls) SET_COLUMN_TYPES(ftLong,long)
+///< <i>set long type values of a batch of rows of a column by index</i><br>
 ///< <b>input:</b>
 ///< <ul>
 ///< <li>const size_t &col:&emsp; column index</li>
-///< <li>const double &value:&emsp; value</li>
+///< <li>std::span<const int64_t> values:&emsp; values</li>
+///< <li>std::span<const bool> nulls:&emsp; null flags (optional)</li>
 ///< </ul>
-void sqream::driver::set_date(const std::string &col_name,const uint32_t value) NAMED_SETS
-///< <i>set a date type value of a column by name</i><br>
+void sqream::driver::set_float_column(const size_t col,std::span<const float> values,std::span<const bool> nulls) SET_COLUMN_TYPES(ftFloat,float)
+///< <i>set float type values of a batch of rows of a column by index</i><br>
 ///< <b>input:</b>
 ///< <ul>
 ///< <li>const size_t &col:&emsp; column index</li>
-///< <li>const uint32_t &value:&emsp; value</li>
+///< <li>std::span<const float> values:&emsp; values</li>
+///< <li>std::span<const bool> nulls:&emsp; null flags (optional)</li>
 ///< </ul>
-void sqream::driver::set_datetime(const std::string &col_name,const uint64_t value) NAMED_SETS
-///< <i>set a datetime type value of a column by name</i><br>
+void sqream::driver::set_double_column(const size_t col,std::span<const double> values,std::span<const bool> nulls) SET_COLUMN_TYPES(ftDouble,double)
+///< <i>set double type values of a batch of rows of a column by index</i><br>
 ///< <b>input:</b>
 ///< <ul>
 ///< <li>const size_t &col:&emsp; column index</li>
-///< <li>const uint64_t &value:&emsp; value</li>
+///< <li>std::span<const double> values:&emsp; values</li>
+///< <li>std::span<const bool> nulls:&emsp; null flags (optional)</li>
 ///< </ul>
-void sqream::driver::set_varchar(const std::string &col_name,const std::string &value) NAMED_SETS
-///< <i>set a varchar type value of a column by name</i><br>
+void sqream::driver::set_date_column(const size_t col,std::span<const uint32_t> values,std::span<const bool> nulls) SET_COLUMN_TYPES(ftDate,date)
+///< <i>set date type values of a batch of rows of a column by index</i><br>
 ///< <b>input:</b>
 ///< <ul>
 ///< <li>const size_t &col:&emsp; column index</li>
-///< <li>const std::string &value:&emsp; value</li>
+///< <li>std::span<const uint32_t> values:&emsp; values</li>
+///< <li>std::span<const bool> nulls:&emsp; null flags (optional)</li>
 ///< </ul>
-void sqream::driver::set_nvarchar(const std::string &col_name,const std::string &value) NAMED_SETS
-///< <i>set a nvarchar type value of a column by name</i><br>
+void sqream::driver::set_datetime_column(const size_t col,std::span<const uint64_t> values,std::span<const bool> nulls) SET_COLUMN_TYPES(ftDateTime,datetime)
+///< <i>set datetime type values of a batch of rows of a column by index</i><br>
 ///< <b>input:</b>
 ///< <ul>
 ///< <li>const size_t &col:&emsp; column index</li>
-///< <li>const std::string &value:&emsp; value</li>
+///< <li>std::span<const uint64_t> values:&emsp; values</li>
+///< <li>std::span<const bool> nulls:&emsp; null flags (optional)</li>
 ///< </ul>
-#undef NAMED_SETS
-
-uint32_t sqream::date_t::get()
-{
-    const int32_t m=(month + 9)%12;
-    const int32_t y=year-m/10;
-    return 365*y+y/4-y/100+y/400+(m*306+5)/10+(day-1);
-}
+#undef SET_COLUMN_TYPES
 
-void sqream::date_t::set(uint32_t date)
+void sqream::driver::set_varchar_column(const size_t col,std::span<const std::string> values,std::span<const bool> nulls)
 {
-    const int64_t dlong=(int64_t)(*(int32_t*)&date);
+    ///< <i>set varchar type values of a batch of rows of a column by index</i><br>
+    ///< <b>input:</b>
+    ///< <ul>
+    ///< <li>const size_t &col:&emsp; column index</li>
+    ///< <li>std::span<const std::string> values:&emsp; values</li>
+    ///< <li>std::span<const bool> nulls:&emsp; null flags (optional)</li>
+    ///< </ul>
+    TCCSCI(sqc_,3,col)
+    if(metadata_input_[col].type_code!=CONSTS::ftVarchar) THROW_GENERAL_ERROR("column is not of type varchar");
+    const size_t size=metadata_input_[col].size;
+    for(const std::string &value:values) if(size<value.size()) THROW_GENERAL_ERROR("string size is bigger than column varchar size");
+    COLUMN_COLCK(values.size())
+    const size_t id=metadata_input_[col].data_block;
+    std::vector<char> &block=pbuffer_[curr_buff_idx][col][id];
+    size_t pos=block.size();
+    block.resize(pos+size*values.size(),' ');
+    for(const std::string &value:values)
+    {
+        memcpy(block.data()+pos,value.data(),value.size());
+        pos+=size;
+    }
+    NULL_COLUMN_WHIPER
+}
+
+void sqream::driver::set_nvarchar_column(const size_t col,std::span<const std::string> values,std::span<const bool> nulls)
+{
+    ///< <i>set nvarchar type values of a batch of rows of a column by index</i><br>
+    ///< <b>input:</b>
+    ///< <ul>
+    ///< <li>const size_t &col:&emsp; column index</li>
+    ///< <li>std::span<const std::string> values:&emsp; values</li>
+    ///< <li>std::span<const bool> nulls:&emsp; null flags (optional)</li>
+    ///< </ul>
+    TCCSCI(sqc_,3,col)
+    if(metadata_input_[col].type_code!=CONSTS::ftBlob and !metadata_input_[col].is_true_varchar) THROW_GENERAL_ERROR("column is not of type nvarchar");
+    COLUMN_COLCK(values.size())
+    const size_t ids=metadata_input_[col].length_block;
+    const size_t idn=metadata_input_[col].data_block;
+    std::vector<char> &sizes=pbuffer_[curr_buff_idx][col][ids];
+    std::vector<char> &data=pbuffer_[curr_buff_idx][col][idn];
+    const size_t I=values.size();
+    size_t spos=sizes.size(),total=0;
+    sizes.resize(spos+sizeof(int)*I);
+    for(size_t i=0;i<I;i++)
+    {
+        /// Null values are sent empty, as set_null() does
+        const int nvarchar_size_container=(!nulls.empty() and nulls[i])?0:values[i].size();
+        memcpy(sizes.data()+spos,&nvarchar_size_container,sizeof(nvarchar_size_container));
+        spos+=sizeof(nvarchar_size_container);
+        total+=nvarchar_size_container;
+    }
+    data.reserve(data.size()+total);
+    for(size_t i=0;i<I;i++) if(nulls.empty() or !nulls[i]) data.insert(data.end(),values[i].begin(),values[i].end());
+    NULL_COLUMN_WHIPER
+}
+#undef COLUMN_COLCK
+#undef NULL_COLUMN_WHIPER
+
+void sqream::driver::set_null(const std::string &col_name)
+{
+    /// <i>nullify value of a column by name</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t &col:&emsp; column index</li>
+    /// <li>const bool &col:&emsp; value</li>
+    /// </ul>
+    set_null(get_column_index(col_name));
+}
+
+/*!
+\def NAMED_SETS(X)
+<i>This macro implements all <b>set</b> calls by column name</i>
+<b>input:</b>
+<ul>
+<li>\a X:&emsp; function name by column index</li>
+</ul>
+*/
+#define NAMED_SETS(X)\
+{\
+    X(get_column_index(col_name),value);\
+}
+void sqream::driver::set_bool(const std::string &col_name,const bool value) NAMED_SETS(set_bool)
+///< <i>set a bool type value of a column by name</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< <li>const bool &value:&emsp; value</li>
+///< </ul>
+void sqream::driver::set_ubyte(const std::string &col_name,const uint8_t value) NAMED_SETS(set_ubyte)
+///< <i>set a unsigned byte type value of a column by name</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< <li>const uint8_t &value:&emsp; value</li>
+///< </ul>
+void sqream::driver::set_short(const std::string &col_name,const uint16_t value) NAMED_SETS(set_short)
+///< <i>set a short type value of a column by name</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< <li>const int16_t &value:&emsp; value</li>
+///< </ul>
+void sqream::driver::set_int(const std::string &col_name,const uint32_t value) NAMED_SETS(set_int)
+///< <i>set a int type value of a column by name</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< <li>const int32_t &value:&emsp; value</li>
+///< </ul>
+void sqream::driver::set_long(const std::string &col_name,const uint64_t value) NAMED_SETS(set_long)
+///< <i>set a long type value of a column by name</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< <li>const int64_t &value:&emsp; value</li>
+///< </ul>
+void sqream::driver::set_float(const std::string &col_name,const float value) NAMED_SETS(set_float)
+///< <i>set a float type value of a column by name</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< <li>const float &value:&emsp; value</li>
+///< </ul>
+void sqream::driver::set_double(const std::string &col_name,const double value) NAMED_SETS(set_double)
+///< <i>set a double type value of a column by name</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< <li>const double &value:&emsp; value</li>
+///< </ul>
+void sqream::driver::set_date(const std::string &col_name,const uint32_t value) NAMED_SETS(set_date)
+///< <i>set a date type value of a column by name</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< <li>const uint32_t &value:&emsp; value</li>
+///< </ul>
+void sqream::driver::set_datetime(const std::string &col_name,const uint64_t value) NAMED_SETS(set_datetime)
+///< <i>set a datetime type value of a column by name</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< <li>const uint64_t &value:&emsp; value</li>
+///< </ul>
+void sqream::driver::set_varchar(const std::string &col_name,const std::string &value) NAMED_SETS(set_varchar)
+///< <i>set a varchar type value of a column by name</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< <li>const std::string &value:&emsp; value</li>
+///< </ul>
+void sqream::driver::set_nvarchar(const std::string &col_name,const std::string &value) NAMED_SETS(set_nvarchar)
+///< <i>set a nvarchar type value of a column by name</i><br>
+///< <b>input:</b>
+///< <ul>
+///< <li>const size_t &col:&emsp; column index</li>
+///< <li>const std::string &value:&emsp; value</li>
+///< </ul>
+#undef NAMED_SETS
+
+uint32_t sqream::date_t::get()
+{
+    const int32_t m=(month + 9)%12;
+    const int32_t y=year-m/10;
+    return 365*y+y/4-y/100+y/400+(m*306+5)/10+(day-1);
+}
+
+void sqream::date_t::set(uint32_t date)
+{
+    const int64_t dlong=(int64_t)(*(int32_t*)&date);
     #define dform dlong-(y*365+y/4-y/100+y/400)
     int64_t y=(10000*dlong+14780)/3652425;
     int64_t d=dform;
@@ -1428,8 +2989,7 @@ void sqream::new_query_execute(driver *drv, std::string sql_query) {
     /// </ul>
     TC(drv->sqc_)
     try{
-        drv->new_query(sql_query);
-        drv->execute_query();
+        drv->new_execute_query(sql_query);
     }
     catch(std::string &err)
     {
@@ -1485,5 +3045,861 @@ sqream::CONSTS::statement_type sqream::retrieve_statement_type(driver *drv) {
     return drv->statement_type_;
 }
 
+
+//   ----  Parallel loader object
+//   ----------------------------
+
+sqream::parallel_loader::parallel_loader(const size_t sessions) {
+    /// <i>Parallel loader constructor</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t sessions:&emsp; number of connections the rows are spread over</li>
+    /// </ul>
+    if(!sessions) THROW_GENERAL_ERROR("parallel loader needs at least 1 session");
+    for(size_t idx=0;idx<sessions;idx++) sessions_.emplace_back(new driver);
+    failed_=false;
+    rows_=0;
+    bytes_=0;
+    base_bytes_=0;
+    started_=false;
+}
+
+sqream::parallel_loader::~parallel_loader() {
+    /// <i>Destructor, sessions still loading are dropped without closing their statements</i><br>
+    if(started_) {
+        for(std::unique_ptr<driver> &drv:sessions_) drv->disconnect();
+        started_=false;
+    }
+}
+
+bool sqream::parallel_loader::connect(const std::string &ipv4,int port,bool ssl,const std::string &username,const std::string &password,const std::string &database,const std::string &service) {
+    /// <i>Connect every session to a given ipv4, port, database on sqreamd</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const std::string &ipv4:&emsp; ipv4 of sqreamd</li>
+    /// <li>int port:&emsp; port of sqreamd</li>
+    /// <li>bool ssl:&emsp; connect with an SSL session</li>
+    /// <li>const std::string &username:&emsp; username</li>
+    /// <li>const std::string &password:&emsp; password</li>
+    /// <li>const std::string &database:&emsp; database name</li>
+    /// </ul>
+    /// If one session fails to connect the others are disconnected again.
+    try {
+        for(std::unique_ptr<driver> &drv:sessions_) if(!drv->connect(ipv4,port,ssl,username,password,database,service)) THROW_GENERAL_ERROR("error connecting session");
+    }
+    catch(std::string &err) {
+        disconnect();
+        throw;
+    }
+    return true;
+}
+
+void sqream::parallel_loader::disconnect() {
+    /// <i>Disconnect every session</i><br>
+    for(std::unique_ptr<driver> &drv:sessions_) drv->disconnect();
+    started_=false;
+}
+
+void sqream::parallel_loader::begin(const std::string &sql_query) {
+    /// <i>Prepare and execute the same insert statement on every session</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const std::string &sql_query:&emsp; SQream SQL insert query with one ? per column</li>
+    /// </ul>
+    if(started_) THROW_GENERAL_ERROR("parallel loader is already loading");
+    for(std::unique_ptr<driver> &drv:sessions_) if(!drv->sqc_) THROW_GENERAL_ERROR("sqream driver is not connected");
+    error_.clear();
+    failed_=false;
+    rows_=0;
+    bytes_=0;
+    base_bytes_=sent_bytes_();
+    started_=true;
+    start_=end_=std::chrono::steady_clock::now();
+    for(size_t idx=0;idx<sessions_.size();idx++) {
+        try {
+            new_query_execute(sessions_[idx].get(),sql_query);
+            if(sessions_[idx]->statement_type_!=CONSTS::insert) THROW_GENERAL_ERROR("parallel loader needs an insert statement");
+        }
+        catch(std::string &err) {
+            fail_(idx,err);
+            abandon_();
+        }
+    }
+}
+
+void sqream::parallel_loader::load(const size_t batches,const std::function<size_t(driver &,size_t)> &fill) {
+    /// <i>Set batches of rows on all sessions at once, batch b goes to session b % sessions()</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t batches:&emsp; number of batches</li>
+    /// <li>const std::function<size_t(driver &,size_t)> &fill:&emsp; sets the rows of a batch on the given driver with the set_* functions and next_query_row()/next_query_rows(), returns the number of rows set</li>
+    /// </ul>
+    /// The callback runs on one thread per session, so it is called concurrently for different sessions.
+    /// Once a session fails the others stop taking batches, every session is dropped without closing its statement and the first error is raised.
+    if(!started_) THROW_GENERAL_ERROR("parallel loader is not loading");
+    std::vector<std::unique_ptr<std::future<void>>> workers;
+    for(size_t idx=0;idx<sessions_.size();idx++) {
+        workers.emplace_back(new std::future<void>(std::async(std::launch::async,[this,idx,batches,&fill] {
+            try {
+                for(size_t batch=idx;batch<batches and !failed_;batch+=sessions_.size()) rows_+=fill(*sessions_[idx],batch);
+            }
+            catch(std::string &err) {
+                fail_(idx,err);
+            }
+            catch(std::exception &err) {
+                fail_(idx,err.what());
+            }
+        })));
+    }
+    for(std::unique_ptr<std::future<void>> &worker:workers) worker->get();
+    if(failed_) abandon_();
+}
+
+void sqream::parallel_loader::finish() {
+    /// <i>Send the rows still buffered and close the statement on every session</i><br>
+    /// Sessions finish in parallel. If one fails the remaining ones are dropped and the first error is raised.
+    if(!started_) THROW_GENERAL_ERROR("parallel loader is not loading");
+    std::vector<std::unique_ptr<std::future<void>>> workers;
+    for(size_t idx=0;idx<sessions_.size();idx++) {
+        workers.emplace_back(new std::future<void>(std::async(std::launch::async,[this,idx] {
+            try {
+                sessions_[idx]->finish_query();
+            }
+            catch(std::string &err) {
+                fail_(idx,err);
+            }
+        })));
+    }
+    for(std::unique_ptr<std::future<void>> &worker:workers) worker->get();
+    bytes_=sent_bytes_()-base_bytes_;
+    end_=std::chrono::steady_clock::now();
+    if(failed_) abandon_();
+    started_=false;
+}
+
+size_t sqream::parallel_loader::sessions() {
+    /// <b>return</b>(size_t):&emsp; number of sessions
+    return sessions_.size();
+}
+
+sqream::driver &sqream::parallel_loader::session(const size_t idx) {
+    /// <i>Access one session, e.g. to tune its buffers or to load it from a thread of the caller</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const size_t idx:&emsp; session index</li>
+    /// </ul>
+    /// <b>return</b>(driver &):&emsp; driver of the session
+    if(idx>=sessions_.size()) THROW_GENERAL_ERROR("session does not exist");
+    return *sessions_[idx];
+}
+
+uint64_t sqream::parallel_loader::rows() {
+    /// <b>return</b>(uint64_t):&emsp; rows set since begin()
+    return rows_;
+}
+
+uint64_t sqream::parallel_loader::bytes() {
+    /// <b>return</b>(uint64_t):&emsp; binary bytes sent since begin()
+    return started_ ? sent_bytes_()-base_bytes_ : bytes_;
+}
+
+double sqream::parallel_loader::seconds() {
+    /// <b>return</b>(double):&emsp; seconds from begin() to finish(), or to now while loading
+    const std::chrono::steady_clock::time_point end=started_ ? std::chrono::steady_clock::now() : end_;
+    return std::chrono::duration<double>(end-start_).count();
+}
+
+double sqream::parallel_loader::rows_per_second() {
+    /// <b>return</b>(double):&emsp; rows loaded per second over all sessions
+    const double elapsed=seconds();
+    return elapsed>0 ? rows()/elapsed : 0;
+}
+
+double sqream::parallel_loader::bytes_per_second() {
+    /// <b>return</b>(double):&emsp; binary bytes sent per second over all sessions
+    const double elapsed=seconds();
+    return elapsed>0 ? bytes()/elapsed : 0;
+}
+
+void sqream::parallel_loader::fail_(const size_t idx,const std::string &err) {
+    /// <i>Keep the first error and make the other sessions stop</i><br>
+    std::unique_lock<std::mutex> lock(mut_);
+    if(!failed_) error_="session "+std::to_string(idx)+": "+err;
+    failed_=true;
+}
+
+void sqream::parallel_loader::abandon_() {
+    /// <i>Drop every session without closing its statement and raise the first error</i><br>
+    /// The sessions stay allocated, connect() makes them usable again.
+    end_=std::chrono::steady_clock::now();
+    for(std::unique_ptr<driver> &drv:sessions_) drv->disconnect();
+    started_=false;
+    const std::string error=error_;
+    throw error;
+}
+
+uint64_t sqream::parallel_loader::sent_bytes_() {
+    /// <b>return</b>(uint64_t):&emsp; binary bytes put by every connected session
+    uint64_t total=0;
+    for(std::unique_ptr<driver> &drv:sessions_) if(drv->sqc_) total+=drv->sqc_->put_bytes_;
+    return total;
+}
+
+
+//   ----  Connection pool object
+//   ----------------------------
+
+sqream::connection_pool::connection_pool(const std::string &ipv4,int port,bool ssl,const std::string &username,const std::string &password,const std::string &database,const std::string &service,size_t min_sessions,size_t max_sessions,std::chrono::milliseconds idle_timeout) {
+    /// <i>Connection pool constructor, connects the minimum number of sessions right away</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>const std::string &ipv4:&emsp; ipv4 of sqreamd</li>
+    /// <li>int port:&emsp; port of sqreamd</li>
+    /// <li>bool ssl:&emsp; connect with SSL sessions</li>
+    /// <li>const std::string &username:&emsp; username</li>
+    /// <li>const std::string &password:&emsp; password</li>
+    /// <li>const std::string &database:&emsp; database name</li>
+    /// <li>size_t min_sessions:&emsp; sessions kept open even when idle</li>
+    /// <li>size_t max_sessions:&emsp; most sessions open at once, checkout() waits beyond it</li>
+    /// <li>std::chrono::milliseconds idle_timeout:&emsp; idle time after which sessions above the minimum are closed</li>
+    /// </ul>
+    if(!max_sessions or min_sessions>max_sessions) THROW_GENERAL_ERROR("connection pool needs min_sessions <= max_sessions and max_sessions > 0");
+    ipv4_=ipv4;
+    port_=port;
+    ssl_=ssl;
+    username_=username;
+    password_=password;
+    database_=database;
+    service_=service;
+    min_=min_sessions;
+    max_=max_sessions;
+    idle_timeout_=idle_timeout;
+    open_=0;
+    warm();
+}
+
+sqream::connection_pool::~connection_pool() {
+    /// <i>Close the idle sessions</i><br>
+    /// Sessions still checked out belong to their drivers from now on and are closed by driver::disconnect().
+    /// Those drivers must not be checked in or disconnected by another thread while the pool is destroyed.
+    std::unique_lock<std::mutex> lock(mut_);
+    for(driver *drv:lent_) drv->pool_=nullptr;
+    lent_.clear();
+    for(std::pair<connector *,std::chrono::steady_clock::time_point> &entry:idle_) delete entry.first;
+    idle_.clear();
+}
+
+void sqream::connection_pool::checkout(driver &drv,std::chrono::milliseconds timeout) {
+    /// <i>Attach a connected session to a driver that is not connected</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>driver &drv:&emsp; driver the session is handed to</li>
+    /// <li>std::chrono::milliseconds timeout:&emsp; time to wait for a session to be returned when max_sessions are checked out</li>
+    /// </ul>
+    /// The most recently returned idle session is checked first, sessions found closed by the server are dropped.
+    /// The driver keeps its prefetch and fetch pipeline settings, the session must be given back with checkin().
+    if(drv.sqc_) THROW_GENERAL_ERROR("sqream driver is already connected");
+    const std::chrono::steady_clock::time_point deadline=std::chrono::steady_clock::now()+timeout;
+    connector *conn=nullptr;
+    std::unique_lock<std::mutex> lock(mut_);
+    while(!conn) {
+        evict_expired_(lock);
+        if(!idle_.empty()) {
+            conn=idle_.back().first;
+            idle_.pop_back();
+            lock.unlock();
+            if(!conn->socket or !conn->socket->SockIsAlive()) {
+                drop_(conn,false);
+                conn=nullptr;
+            }
+            lock.lock();
+            if(!conn) open_--;
+        }
+        else if(open_<max_) {
+            open_++;
+            lock.unlock();
+            try {
+                conn=open_session_();
+            }
+            catch(std::string &err) {
+                lock.lock();
+                open_--;
+                cv_.notify_one();
+                throw;
+            }
+            lock.lock();
+        }
+        else if(cv_.wait_until(lock,deadline)==std::cv_status::timeout and idle_.empty() and open_>=max_)
+            THROW_GENERAL_ERROR("connection pool exhausted");
+    }
+    lent_.push_back(&drv);
+    lock.unlock();
+    conn->set_fetch_pipeline(drv.fetch_pipeline_,drv.fetch_window_);
+    conn->set_statement_cache(drv.statement_cache_size_);
+    conn->set_read_ahead(drv.read_ahead_);
+    conn->set_io_backend(drv.io_backend_);
+    conn->set_zerocopy(drv.zerocopy_);
+    drv.sqc_=conn;
+    drv.pool_=this;
+    drv.state_=0;
+}
+
+void sqream::connection_pool::checkin(driver &drv) {
+    /// <i>Detach the session of a driver and keep it for the next checkout</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>driver &drv:&emsp; driver the session was handed to</li>
+    /// </ul>
+    /// A statement left open is closed first, sessions that fail to close it are dropped.
+    if(!drv.sqc_) return;
+    {
+        /// pool_ and lent_ are only read and written with mut_ held, see ~connection_pool()
+        std::unique_lock<std::mutex> lock(mut_);
+        if(drv.pool_!=this) THROW_GENERAL_ERROR("session was not checked out from this pool");
+        lent_.erase(std::find(lent_.begin(),lent_.end(),&drv));
+        drv.pool_=nullptr;
+    }
+    bool healthy=true;
+    try {
+        drv.prefetch_.stop();
+        drv.drain_puts_();
+        if(drv.state_>0 and drv.state_<8) drv.sqc_->close_statement();
+    }
+    catch(...) {
+        healthy=false;
+    }
+    connector *conn=drv.sqc_;
+    drv.sqc_=nullptr;
+    drv.state_=0;
+    if(!healthy or !conn->socket) {
+        drop_(conn,false);
+        std::unique_lock<std::mutex> lock(mut_);
+        open_--;
+        cv_.notify_one();
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mut_);
+    idle_.emplace_back(conn,std::chrono::steady_clock::now());
+    cv_.notify_one();
+}
+
+void sqream::connection_pool::warm() {
+    /// <i>Connect new sessions until min_sessions are open</i><br>
+    std::unique_lock<std::mutex> lock(mut_);
+    while(open_<min_) {
+        open_++;
+        lock.unlock();
+        connector *conn;
+        try {
+            conn=open_session_();
+        }
+        catch(std::string &err) {
+            lock.lock();
+            open_--;
+            throw;
+        }
+        lock.lock();
+        idle_.emplace_back(conn,std::chrono::steady_clock::now());
+        cv_.notify_one();
+    }
+}
+
+void sqream::connection_pool::evict_idle() {
+    /// <i>Close the sessions above min_sessions that have been idle longer than the idle timeout</i><br>
+    /// Also done on every checkout.
+    std::unique_lock<std::mutex> lock(mut_);
+    evict_expired_(lock);
+}
+
+size_t sqream::connection_pool::size() {
+    /// <b>return</b>(size_t):&emsp; sessions open, idle or checked out
+    std::unique_lock<std::mutex> lock(mut_);
+    return open_;
+}
+
+size_t sqream::connection_pool::idle() {
+    /// <b>return</b>(size_t):&emsp; sessions waiting for a checkout
+    std::unique_lock<std::mutex> lock(mut_);
+    return idle_.size();
+}
+
+sqream::connector *sqream::connection_pool::open_session_() {
+    /// <i>Connect and authenticate a new session</i><br>
+    /// <b>return</b>(connector *):&emsp; connected session
+    std::unique_ptr<connector> conn(new connector);
+    conn->connect(ipv4_,port_,ssl_,username_,password_,database_,service_);
+    return conn.release();
+}
+
+void sqream::connection_pool::evict_expired_(std::unique_lock<std::mutex> &lock) {
+    /// <i>Close the oldest idle sessions while they are expired and more than min_sessions are open</i><br>
+    const std::chrono::steady_clock::time_point now=std::chrono::steady_clock::now();
+    std::vector<connector *> expired;
+    while(!idle_.empty() and open_>min_ and now-idle_.front().second>=idle_timeout_) {
+        expired.push_back(idle_.front().first);
+        idle_.pop_front();
+        open_--;
+    }
+    if(expired.empty()) return;
+    lock.unlock();
+    for(connector *conn:expired) drop_(conn,true);
+    lock.lock();
+}
+
+void sqream::connection_pool::drop_(connector *conn,bool healthy) {
+    /// <i>Close a session leaving the pool</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>connector *conn:&emsp; session</li>
+    /// <li>bool healthy:&emsp; say goodbye to the server, otherwise just close the socket</li>
+    /// </ul>
+    if(!healthy and conn->socket) {
+        conn->socket->SockClose();
+        delete conn->socket;
+        conn->socket=nullptr;
+    }
+    delete conn;
+}
+
+//   ----  Reactor object
+//   --------------------
+
+#ifdef __linux__
+static void wake(sqream::async_loop &loop) ///< <h3>Method to interrupt the epoll_wait of a loop</h3>
+{
+    const uint64_t one=1;
+    if(::write(loop.wake_fd,&one,sizeof(one))) {}
+}
+
+static void finish(sqream::async_operation &op) ///< <h3>Method to call the completion of a retired request</h3>
+{
+    switch(op.kind) {
+        case sqream::async_operation::execute:
+            if(op.executed) op.executed(op.error,op.type,op.metadata_in,op.metadata_out);
+            break;
+        case sqream::async_operation::fetch:
+            if(op.fetched) op.fetched(op.error,op.rows,op.binary_data,op.column_sizes);
+            break;
+        case sqream::async_operation::put:
+            if(op.putted) op.putted(op.error);
+            break;
+    }
+}
+
+sqream::reactor::reactor(size_t threads) {
+    /// <i>Reactor constructor, starts the event loop threads</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>size_t threads:&emsp; number of event loops, attached connections are spread over them</li>
+    /// </ul>
+    /// Completions are called on the loop threads, they must not block for long, throw, or call detach().
+    if(!threads) THROW_GENERAL_ERROR("reactor needs at least one thread");
+    for(size_t i=0;i<threads;i++) {
+        std::unique_ptr<async_loop> loop(new async_loop);
+        loop->epoll_fd=epoll_create1(EPOLL_CLOEXEC);
+        loop->wake_fd=eventfd(0,EFD_NONBLOCK|EFD_CLOEXEC);
+        epoll_event event{};
+        event.events=EPOLLIN;
+        event.data.ptr=nullptr;
+        if(loop->epoll_fd==-1 or loop->wake_fd==-1 or epoll_ctl(loop->epoll_fd,EPOLL_CTL_ADD,loop->wake_fd,&event)==-1) {
+            if(loop->epoll_fd!=-1) close(loop->epoll_fd);
+            if(loop->wake_fd!=-1) close(loop->wake_fd);
+            for(std::unique_ptr<async_loop> &made:loops_) {
+                close(made->epoll_fd);
+                close(made->wake_fd);
+            }
+            THROW_GENERAL_ERROR("could not create event loop");
+        }
+        loops_.push_back(std::move(loop));
+    }
+    for(std::unique_ptr<async_loop> &loop:loops_)
+        loop->thread=std::async(std::launch::async,&reactor::run_,this,std::ref(*loop));
+}
+
+sqream::reactor::~reactor() {
+    /// <i>Reactor destructor, stops the loops</i><br>
+    /// Requests still pending fail with an error, connections still attached go back to blocking mode.
+    for(std::unique_ptr<async_loop> &loop:loops_) {
+        std::lock_guard<std::mutex> lock(loop->mut);
+        loop->stop=true;
+        wake(*loop);
+    }
+    for(std::unique_ptr<async_loop> &loop:loops_) loop->thread.wait();
+    for(auto &attached:attached_) {
+        if(attached.first->socket) attached.first->socket->SockSetNonBlocking(false);
+        delete attached.second.second;
+    }
+    for(std::unique_ptr<async_loop> &loop:loops_) {
+        close(loop->epoll_fd);
+        close(loop->wake_fd);
+    }
+}
+
+void sqream::reactor::attach(connector &conn) {
+    /// <i>Hand a connection to the reactor, on the least busy loop</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>connector &conn:&emsp; connection with a prepared statement (e.g. open_prepare_statement())</li>
+    /// </ul>
+    /// Until detach() the connection is driven by the reactor only and must not be used directly.
+    if(!conn.socket) THROW_GENERAL_ERROR("not connected");
+    conn.drain_fetches();
+    std::lock_guard<std::mutex> lock(mut_);
+    if(attached_.count(&conn)) THROW_GENERAL_ERROR("connection already attached");
+    std::vector<size_t> load(loops_.size(),0);
+    async_loop *loop=nullptr;
+    for(auto &attached:attached_)
+        for(size_t i=0;i<loops_.size();i++) if(loops_[i].get()==attached.second.first) load[i]++;
+    loop=loops_[std::min_element(load.begin(),load.end())-load.begin()].get();
+
+    if(!conn.socket->SockSetNonBlocking(true)) THROW_GENERAL_ERROR("could not make the socket non-blocking");
+    std::unique_ptr<async_session> session(new async_session);
+    session->conn=&conn;
+    epoll_event event{};
+    event.events=EPOLLIN;
+    event.data.ptr=session.get();
+    if(epoll_ctl(loop->epoll_fd,EPOLL_CTL_ADD,conn.socket->SockHandle(),&event)==-1) {
+        conn.socket->SockSetNonBlocking(false);
+        THROW_GENERAL_ERROR("could not watch the socket");
+    }
+    {
+        std::lock_guard<std::mutex> loop_lock(loop->mut);
+        loop->sessions.push_back(session.get());
+    }
+    attached_[&conn]={loop,session.release()};
+}
+
+void sqream::reactor::detach(connector &conn) {
+    /// <i>Wait until every request of a connection completed and give the connection back</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>connector &conn:&emsp; attached connection, back in blocking mode on return</li>
+    /// </ul>
+    /// Must not be called from a completion.
+    std::pair<async_loop*,async_session*> attached;
+    {
+        std::lock_guard<std::mutex> lock(mut_);
+        auto found=attached_.find(&conn);
+        if(found==attached_.end()) return;
+        attached=found->second;
+    }
+    async_loop &loop=*attached.first;
+    async_session *session=attached.second;
+    {
+        std::unique_lock<std::mutex> lock(loop.mut);
+        session->detaching=true;
+        wake(loop);
+        loop.cv.wait(lock,[&]{ return session->detached or loop.stop; });
+        if(!session->detached) return;                              // the destructor takes care of it
+    }
+    {
+        std::lock_guard<std::mutex> lock(mut_);
+        attached_.erase(&conn);
+    }
+    if(conn.socket) conn.socket->SockSetNonBlocking(false);
+    delete session;
+}
+
+void sqream::reactor::execute(connector &conn,execute_callback done) {
+    /// <i>Execute the prepared statement of an attached connection</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>connector &conn:&emsp; attached connection</li>
+    /// <li>execute_callback done:&emsp; called with the statement type and metadata, or with an error</li>
+    /// </ul>
+    /// execute, queryTypeOut and queryTypeIn are pipelined, as in connector::execute_metadata_query().
+    async_operation op;
+    op.kind=async_operation::execute;
+    op.executed=std::move(done);
+    for(const std::string_view frame:{MESSAGES::execute_frame.view(),MESSAGES::queryTypeOut_frame.view(),MESSAGES::queryTypeIn_frame.view()})
+        op.request.insert(op.request.end(),frame.begin(),frame.end());
+    submit_(conn,std::move(op));
+}
+
+void sqream::reactor::fetch(connector &conn,fetch_callback done) {
+    /// <i>Request the next chunk of the executed select of an attached connection</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>connector &conn:&emsp; attached connection</li>
+    /// <li>fetch_callback done:&emsp; called with the chunk as received (see result_batch), 0 rows past the end, or with an error</li>
+    /// </ul>
+    /// Several fetches may be queued, the chunks come back in order.
+    async_operation op;
+    op.kind=async_operation::fetch;
+    op.fetched=std::move(done);
+    const std::string_view frame=MESSAGES::fetch_frame.view();
+    op.request.assign(frame.begin(),frame.end());
+    submit_(conn,std::move(op));
+}
+
+void sqream::reactor::put(connector &conn,std::vector<char> &&binary_data,size_t rows,put_callback done) {
+    /// <i>Send serialized rows to the executed insert of an attached connection</i><br>
+    /// <b>input:</b>
+    /// <ul>
+    /// <li>connector &conn:&emsp; attached connection</li>
+    /// <li>std::vector<char> &&binary_data:&emsp; rows in wire layout, held by the reactor until sqreamd acknowledged them</li>
+    /// <li>size_t rows:&emsp; number of rows that binary_data contains</li>
+    /// <li>put_callback done:&emsp; called once sqreamd took the rows, or with an error</li>
+    /// </ul>
+    if(binary_data.size()>=CONSTS::MAX_SIZE) THROW_GENERAL_ERROR("binary data overflow");
+    async_operation op;
+    op.kind=async_operation::put;
+    op.putted=std::move(done);
+    char msg[MESSAGES::PUT_FRAME_SIZE];
+    const std::string_view frame=MESSAGES::frame_put(msg,rows);
+    const uint64_t data_size=binary_data.size();
+    op.request.assign(frame.begin(),frame.end());
+    op.request.insert(op.request.end(),HEADER::HEADER_BINARY,HEADER::HEADER_BINARY+HEADER::SIZE);
+    op.request.insert(op.request.end(),(const char*)&data_size,(const char*)&data_size+sizeof(data_size));
+    op.payload=std::move(binary_data);
+    submit_(conn,std::move(op));
+}
+
+void sqream::reactor::submit_(connector &conn,async_operation &&op) {
+    std::pair<async_loop*,async_session*> attached;
+    {
+        std::lock_guard<std::mutex> lock(mut_);
+        auto found=attached_.find(&conn);
+        if(found==attached_.end()) THROW_GENERAL_ERROR("connection not attached");
+        attached=found->second;
+    }
+    {
+        std::lock_guard<std::mutex> lock(attached.first->mut);
+        if(attached.second->detaching) THROW_GENERAL_ERROR("connection is being detached");
+        attached.second->incoming.push_back(std::move(op));
+    }
+    wake(*attached.first);
+}
+
+void sqream::reactor::run_(async_loop &loop) {
+    /// <i>Event loop: takes new requests, moves bytes of the ready sockets and lets detached sessions go</i><br>
+    epoll_event events[64];
+    std::vector<async_session*> ready;
+    while(true) {
+        const int count=epoll_wait(loop.epoll_fd,events,64,-1);
+        ready.clear();
+        for(int i=0;i<count;i++) {
+            if(events[i].data.ptr) ready.push_back((async_session*)events[i].data.ptr);
+            else {
+                uint64_t wakes;
+                if(::read(loop.wake_fd,&wakes,sizeof(wakes))) {}
+            }
+        }
+        bool stop;
+        {
+            std::lock_guard<std::mutex> lock(loop.mut);
+            stop=loop.stop;
+            for(async_session *session:loop.sessions) {
+                if(!stop and session->incoming.empty() and !session->detaching) continue;
+                while(!session->incoming.empty()) {
+                    session->operations.push_back(std::move(session->incoming.front()));
+                    session->incoming.pop_front();
+                }
+                ready.push_back(session);
+            }
+            if(stop) loop.cv.notify_all();
+        }
+        if(ready.size()>1) {
+            std::sort(ready.begin(),ready.end());
+            ready.erase(std::unique(ready.begin(),ready.end()),ready.end());
+        }
+        if(stop) {
+            for(async_session *session:ready) {
+                epoll_ctl(loop.epoll_fd,EPOLL_CTL_DEL,session->conn->socket->SockHandle(),nullptr);
+                fail_(*session,"reactor stopped");
+            }
+            return;
+        }
+        for(async_session *session:ready) pump_(loop,*session);
+
+        std::lock_guard<std::mutex> lock(loop.mut);
+        for(auto it=loop.sessions.begin();it!=loop.sessions.end();) {
+            async_session *session=*it;
+            if(session->detaching and session->operations.empty() and session->incoming.empty()) {
+                epoll_ctl(loop.epoll_fd,EPOLL_CTL_DEL,session->conn->socket->SockHandle(),nullptr);
+                session->detached=true;
+                it=loop.sessions.erase(it);
+                loop.cv.notify_all();
+            }
+            else ++it;
+        }
+    }
+}
+
+void sqream::reactor::pump_(async_loop &loop,async_session &session) {
+    /// <i>Send what the socket takes, receive what it holds, and wait for writability only while requests are unsent</i><br>
+    if(!session.broken.empty()) {
+        fail_(session,session.broken);
+        return;
+    }
+    std::string error;
+    bool failed=true;
+    try {
+        send_(session);
+        receive_(session);
+        failed=false;
+    }
+    catch(std::string &err) {
+        error=err;
+    }
+    catch(std::exception &err) {
+        error=err.what();
+    }
+    /// a completion may throw anything, letting it end the loop thread would leave every detach() waiting
+    catch(...) {}
+    if(failed) {
+        epoll_ctl(loop.epoll_fd,EPOLL_CTL_DEL,session.conn->socket->SockHandle(),nullptr);
+        fail_(session,error.empty() ? "request completion failed with an unknown error" : error);
+        return;
+    }
+    const bool writing=session.send_idx<session.operations.size();
+    if(writing!=session.writing) {
+        epoll_event event{};
+        event.events=writing ? EPOLLIN|EPOLLOUT : EPOLLIN;
+        event.data.ptr=&session;
+        epoll_ctl(loop.epoll_fd,EPOLL_CTL_MOD,session.conn->socket->SockHandle(),&event);
+        session.writing=writing;
+    }
+}
+
+void sqream::reactor::send_(async_session &session) {
+    while(session.send_idx<session.operations.size()) {
+        async_operation &op=session.operations[session.send_idx];
+        const size_t total=op.request.size()+op.payload.size();
+        while(op.sent<total) {
+            const bool in_request=op.sent<op.request.size();
+            const char *data=in_request ? op.request.data()+op.sent : op.payload.data()+(op.sent-op.request.size());
+            const size_t size=in_request ? op.request.size()-op.sent : total-op.sent;
+            size_t bytes_written;
+            const int status=session.conn->socket->SockSendSome(data,size,bytes_written);
+            if(status==SOCK_IO_WOULD_BLOCK) return;
+            if(status!=SOCK_IO_DONE) THROW_GENERAL_ERROR("socket failed to write message block");
+            op.sent+=bytes_written;
+        }
+        if(op.kind==async_operation::put) session.conn->put_bytes_+=op.payload.size();
+        session.send_idx++;
+    }
+}
+
+void sqream::reactor::receive_(async_session &session) {
+    /// <i>Read messages header first, the binary chunk of a fetch goes straight into the buffer handed to its completion</i><br>
+    while(true) {
+        const bool in_header=session.header_got<sizeof(session.header);
+        char *target=in_header ? session.header+session.header_got : session.body+session.body_got;
+        const uint64_t size=in_header ? sizeof(session.header)-session.header_got : session.body_size-session.body_got;
+        size_t bytes_read=0;
+        if(size) {
+            const int status=session.conn->socket->SockRecvSome(target,size,bytes_read);
+            if(status==SOCK_IO_WOULD_BLOCK) return;
+            if(status==SOCK_IO_CLOSED) THROW_GENERAL_ERROR("connection closed by sqreamd");
+            if(status!=SOCK_IO_DONE) THROW_GENERAL_ERROR("socket failed to read content");
+        }
+        if(in_header) {
+            session.header_got+=bytes_read;
+            if(session.header_got<sizeof(session.header)) continue;
+            if(session.header[0]!=HEADER::PROTOCOL_VERSION) THROW_GENERAL_ERROR("protocol version mismatch");
+            if(!session.send_idx) THROW_GENERAL_ERROR("unexpected message from sqreamd");
+            memcpy(&session.body_size,&session.header[2],sizeof(uint64_t));
+            async_operation &op=session.operations.front();
+            if(op.kind==async_operation::fetch and op.replies==1) {
+                op.binary_data.resize(session.body_size);
+                session.body=op.binary_data.data();
+            }
+            else {
+                session.reply.resize(session.body_size);
+                session.body=session.reply.data();
+            }
+            session.body_got=0;
+            continue;
+        }
+        session.body_got+=bytes_read;
+        if(session.body_got<session.body_size) continue;
+        session.header_got=0;
+        async_operation &op=session.operations.front();
+        op.replies++;
+        if(reply_(session,op)) complete_(session);
+    }
+}
+
+bool sqream::reactor::reply_(async_session &session,async_operation &op) {
+    /// <b>return</b>(bool):&emsp; the request got all its replies
+    /// Errors reported by sqreamd fail the request only, the replies still due are consumed so the connection stays in sync.
+    try {
+        switch(op.kind) {
+            case async_operation::execute:
+                if(op.replies==1) {
+                    if(!acked(session.reply,"executed")) THROW_GENERAL_ERROR("failed to execute query");
+                }
+                else if(op.replies==2) {
+                    const json reply_json=json::parse(session.reply.begin(),session.reply.end());
+                    if(parse_metadata_out(reply_json,op.metadata_out)) op.type=CONSTS::statement_type::select;
+                }
+                else {
+                    if(op.type!=CONSTS::statement_type::select) {
+                        const json reply_json=json::parse(session.reply.begin(),session.reply.end());
+                        op.type=parse_metadata_in(reply_json,op.metadata_in) ? CONSTS::statement_type::insert : CONSTS::statement_type::direct;
+                    }
+                    return true;
+                }
+                return false;
+            case async_operation::fetch: {
+                if(op.replies==2) return true;
+                uint64_t rows;
+                if(!read_fetch(session.reply,rows,op.column_sizes)) {
+                    const json reply_json=json::parse(session.reply.begin(),session.reply.end());
+                    if(reply_json.contains("error")) THROW_SQREAM_ERROR(reply_json["error"]);
+                    THROW_GENERAL_ERROR("an unknown error occured");
+                }
+                uint64_t binary_size=0;
+                for(uint64_t size:op.column_sizes) binary_size+=size;
+                if(binary_size) {
+                    op.rows=rows;
+                    return false;
+                }
+                op.column_sizes.clear();
+                return true;
+            }
+            case async_operation::put:
+                if(!scan_ack(session.reply,"putted")) {
+                    const json reply_json=json::parse(session.reply.begin(),session.reply.end());
+                    if(reply_json.contains("error")) THROW_SQREAM_ERROR(reply_json["error"]);
+                    THROW_GENERAL_ERROR("an unknown error occured");
+                }
+                return true;
+        }
+    }
+    catch(std::string &error) {
+        if(op.error.empty()) op.error=error;
+    }
+    catch(json::exception &error) {
+        if(op.error.empty()) op.error=error.what();
+    }
+    return op.kind!=async_operation::execute or op.replies==3;
+}
+
+void sqream::reactor::complete_(async_session &session) {
+    async_operation op=std::move(session.operations.front());
+    session.operations.pop_front();
+    session.send_idx--;
+    finish(op);
+}
+
+void sqream::reactor::fail_(async_session &session,const std::string &error) {
+    /// <i>The connection can't be trusted any more, every request on it fails and so will the later ones</i><br>
+    session.broken=error;
+    session.send_idx=0;
+    session.header_got=0;
+    while(!session.operations.empty()) {
+        async_operation op=std::move(session.operations.front());
+        session.operations.pop_front();
+        if(op.error.empty()) op.error=error;
+        try {
+            finish(op);
+        }
+        catch(...) {}
+    }
+}
+#endif
+
 #undef THROW_GENERAL_ERROR
 #undef THROW_SQREAM_ERROR
@@ -8,13 +8,25 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstdint>
+#include <cstring>
 #include <array>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <future>
 #include <mutex>
 #include <memory>
 #include <atomic>
+#include <span>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <tuple>
+#include <optional>
+#include <type_traits>
 
 #define CPPCONECTOR_MAJOR_VERSION 4
 #define CPPCONECTOR_MINOR_VERSION 0
@@ -23,6 +35,7 @@
 
 /// <h3>SQream low-level connector main namespace</h3>
 struct TSocketClient;
+struct TSockChunk;
 
 namespace sqream
 {
@@ -39,10 +52,35 @@ namespace sqream
     /// <h3>sqream::CONSTS contains all the SQream defined constants</h3>
     namespace CONSTS
     {
-        const uint8_t BUFF_COUNT=2;
+        const uint8_t BUFF_COUNT=2;                                                                 ///< Default number of insert buffers in the ring
         const char DEFAULT_SERVICE[]="sqream";
         const uint32_t MAX_SIZE=1<<30;                                              ///< Maximum message size (2^30 Byte = 1073741824 Byte = 1 GiB)
         const uint32_t MIN_PUT_SIZE=1<<26;                                          ///< Default minimum buffer size (2^26 Byte = 67108864 Byte = 64 MiB)
+        const uint32_t READ_AHEAD=1<<16;                                            ///< Default socket read-ahead buffer size (2^16 Byte = 64 KiB)
+        const uint32_t ZEROCOPY_MIN=1<<20;                                          ///< Smallest binary message sent with MSG_ZEROCOPY (2^20 Byte = 1 MiB)
+        /// <h3>socket transfer backends char enum</h3>
+        enum io_backend:char
+        {
+            blocking,                                                                   ///< Blocking send/recv system calls (default)
+            uring,                                                                      ///< io_uring submissions with registered buffers (Linux, non-TLS connections only)
+        };
+        /// <h3>sqream column types char enum, named after the type names of the metadata replies</h3>
+        enum column_type:char
+        {
+            ftUnknown,                                                                  ///< Type the driver has no accessor for
+            ftBool,                                                                     ///< bool
+            ftUByte,                                                                    ///< tinyint
+            ftShort,                                                                    ///< smallint
+            ftInt,                                                                      ///< int
+            ftLong,                                                                     ///< bigint
+            ftFloat,                                                                    ///< real
+            ftDouble,                                                                   ///< double
+            ftDate,                                                                     ///< date
+            ftDateTime,                                                                 ///< datetime
+            ftVarchar,                                                                  ///< Fixed size, space padded varchar
+            ftBlob,                                                                     ///< nvarchar (true varchar)
+        };
+        const uint8_t NO_BLOCK=0xff;                                                ///< Block index of a block the column does not have
         /// <h3>statement operation types char enum</h3>
         enum statement_type:char
         {
@@ -72,6 +110,28 @@ namespace sqream
 #undef JS1
 #undef JSA
         template<typename ...Args> void format(std::vector<char> &output,const char input[],Args...args);   ///< <h3>Unformatted message formatter (snprintf-wrapper)</h3>
+
+        /// <h3>Constant message framed for the wire at compile time</h3>
+        template<size_t N> struct frame {
+            char bytes[HEADER::SIZE+sizeof(uint64_t)+N-1];                                              ///< PRE_HEADER, little endian body size and body
+            constexpr frame(const char (&body)[N]) : bytes() {
+                bytes[0]=char(HEADER::PROTOCOL_VERSION);
+                bytes[1]=char(HEADER::TYPE_JSON);
+                for(size_t i=0;i<sizeof(uint64_t);i++) bytes[HEADER::SIZE+i]=char(uint64_t(N-1)>>(8*i));
+                for(size_t i=0;i+1<N;i++) bytes[HEADER::SIZE+sizeof(uint64_t)+i]=body[i];
+            }
+            std::string_view view() const { return std::string_view(bytes,sizeof(bytes)); }         ///< <h3>Whole frame</h3>
+        };
+        constexpr frame closeConnection_frame(closeConnection);                                         ///< Framed closeConnection message
+        constexpr frame closeStatement_frame(closeStatement);                                           ///< Framed closeStatement message
+        constexpr frame getStatementId_frame(getStatementId);                                           ///< Framed getStatementId message
+        constexpr frame queryTypeOut_frame(queryTypeOut);                                               ///< Framed queryTypeOut message
+        constexpr frame queryTypeIn_frame(queryTypeIn);                                                 ///< Framed queryTypeIn message
+        constexpr frame execute_frame(execute);                                                         ///< Framed execute message
+        constexpr frame fetch_frame(fetch);                                                             ///< Framed fetch message
+        const size_t PUT_FRAME_SIZE=HEADER::SIZE+sizeof(uint64_t)+sizeof(put)+20;                       ///< Room needed by a framed put message
+        std::string_view frame_put(char output[PUT_FRAME_SIZE],uint64_t rows);                          ///< <h3>Frame a put message without allocating</h3>
+        std::string_view frame_prepare(std::vector<char> &output,const std::string &sql_query,int chunk_size);  ///< <h3>Frame a prepareStatement message into a reused buffer</h3>
     }
 
     struct column {
@@ -81,6 +141,60 @@ namespace sqream
         std::string type;                                                                               ///< <h3>Sqream datatype of column</h3>
         unsigned size;                                                                                  ///< <h3>Size in bytes of sqream datatype</h3>
         unsigned scale;                                                                                 ///< <h3>Scale of chunk</h3>
+        CONSTS::column_type type_code=CONSTS::ftUnknown;                                                ///< <h3>Sqream datatype of column, resolved from type</h3>
+        uint8_t null_block=CONSTS::NO_BLOCK;                                                            ///< <h3>Index of the null flags block among the column blocks</h3>
+        uint8_t length_block=CONSTS::NO_BLOCK;                                                          ///< <h3>Index of the value lengths block among the column blocks</h3>
+        uint8_t data_block=0;                                                                           ///< <h3>Index of the data block among the column blocks</h3>
+        uint8_t blocks=1;                                                                               ///< <h3>Number of blocks the column is sent in</h3>
+        void resolve();                                                                                 ///< <h3>Resolve type_code and the block indices from the parsed metadata</h3>
+    };
+
+    /// <h3>Allocator leaving new elements uninitialized, for buffers that are about to be overwritten</h3>
+    template<typename T> struct uninitialized_allocator : std::allocator<T> {
+        template<typename U> struct rebind { using other=uninitialized_allocator<U>; };
+        template<typename U> void construct(U *ptr) noexcept { ::new((void*)ptr) U; }                   ///< Default instead of value initialization
+        template<typename U,typename ...Args> void construct(U *ptr,Args&&...args) { ::new((void*)ptr) U(std::forward<Args>(args)...); }
+    };
+    typedef std::vector<char,uninitialized_allocator<char>> raw_buffer;                                 ///< Byte buffer whose resize() does not zero fill
+
+    /// <h3>Location of the blocks of one column inside a fetched chunk</h3>
+    struct column_view {
+        size_t null_offset;                                                                             ///< <h3>Offset of the null flags block</h3> (nullable columns only)
+        size_t length_offset;                                                                           ///< <h3>Offset of the value lengths block</h3> (true varchar columns only)
+        size_t data_offset;                                                                             ///< <h3>Offset of the data block</h3>
+        size_t data_size;                                                                               ///< <h3>Size in bytes of the data block</h3>
+        std::vector<uint64_t> value_offsets;                                                            ///< <h3>Offset of every row value inside the data block</h3> (true varchar columns only)
+    };
+
+    /// <h3>Fetched result chunk, kept as received from sqreamd</h3>
+    struct result_batch {
+        raw_buffer buffer;                                                                              ///< <h3>Raw chunk as read from the socket</h3>
+        std::vector<uint64_t> column_sizes;                                                             ///< <h3>Block sizes reported by the fetch reply</h3>
+        std::vector<column_view> columns;                                                               ///< <h3>Per column offsets into the buffer</h3>
+        std::vector<std::vector<uint64_t>> aligned_copies;                                              ///< <h3>Aligned copies of data blocks that are misaligned in the buffer</h3>
+        size_t row_count=0;                                                                             ///< <h3>Rows held by the chunk</h3>
+        void index(const std::vector<column> &metadata);                                                ///< <h3>Resolve the column views of a newly fetched chunk</h3>
+        void clear();                                                                                   ///< <h3>Drop the chunk</h3>
+        const char *null_block(const size_t col) const;                                                 ///< <h3>Null flags of a column</h3>
+        const char *length_block(const size_t col) const;                                               ///< <h3>Value lengths of a true varchar column</h3>
+        const char *data_block(const size_t col) const;                                                 ///< <h3>Data of a column</h3>
+        const char *aligned_data_block(const size_t col,const size_t alignment);                        ///< <h3>Data of a column, suitably aligned to be read as an array</h3>
+    };
+
+    /// <h3>Statement type and metadata remembered for a SQL text</h3>
+    struct cached_statement {
+        std::string sql;                                                                                                            ///< <h3>SQL text the statement was prepared from</h3>
+        CONSTS::statement_type type;                                                                                                ///< <h3>Statement type</h3>
+        std::vector<column> metadata_in;                                                                                            ///< <h3>Input columns (insert)</h3>
+        std::vector<column> metadata_out;                                                                                           ///< <h3>Output columns (select)</h3>
+    };
+
+    /// <h3>Expected sqream type of one column of a typed cursor</h3>
+    struct typed_column {
+        CONSTS::column_type type;                                                                       ///< <h3>sqream type</h3>
+        CONSTS::column_type alt_type;                                                                   ///< <h3>Other sqream type accepted, or CONSTS::ftUnknown</h3>
+        const char *name;                                                                               ///< <h3>sqream type name, for error messages</h3>
+        bool optional;                                                                                  ///< <h3>Null values can be represented</h3>
     };
 
     /// <h3>Low level connector</h3>
@@ -96,10 +210,32 @@ namespace sqream
         std::string var_encoding_;
         uint32_t connection_id_;                                                                                                    ///< <h3>Newest connection id</h3> (internal)
         uint32_t statement_id_;                                                                                                     ///< <h3>Newest statement id</h3> (internal)
+        uint32_t fetch_pipeline_;                                                                                                   ///< <h3>Maximum fetch requests in flight</h3> (internal)
+        uint64_t fetch_window_;                                                                                                     ///< <h3>Maximum expected bytes of fetch replies in flight</h3> (internal)
+        uint32_t fetch_outstanding_;                                                                                                ///< <h3>Fetch requests sent but not answered yet</h3> (internal)
+        uint64_t last_chunk_size_;                                                                                                  ///< <h3>Size of the last fetched chunk</h3> (internal)
+        uint64_t put_bytes_;                                                                                                        ///< <h3>Binary bytes sent by put messages on this connection</h3> (internal)
+        std::vector<char> frame_buffer_;                                                                                            ///< <h3>Send buffer reused by the prepareStatement frames</h3> (internal)
+        std::vector<char> reply_buffer_;                                                                                            ///< <h3>Receive buffer reused by the hot path replies</h3> (internal)
+        std::string statement_sql_;                                                                                                 ///< <h3>SQL text of the newest prepared statement</h3> (internal)
+        size_t statement_cache_size_;                                                                                               ///< <h3>Most statements kept in the cache, 0 disables it</h3> (internal)
+        size_t read_ahead_;                                                                                                         ///< <h3>Socket read-ahead buffer size, 0 disables it</h3> (internal)
+        bool ktls_;                                                                                                                 ///< <h3>Ask for kernel TLS on new sockets</h3> (internal)
+        CONSTS::io_backend io_backend_;                                                                                             ///< <h3>Requested socket transfer backend</h3> (internal)
+        std::vector<TSockChunk> registered_buffers_;                                                                                ///< <h3>Scratch list of the buffers registered with the io backend</h3> (internal)
+        bool zerocopy_;                                                                                                             ///< <h3>Send large binary messages with MSG_ZEROCOPY</h3> (internal)
+        uint64_t write_size_;                                                                                                       ///< <h3>Size field of the message being written</h3> (internal)
+        std::list<cached_statement> statement_cache_;                                                                               ///< <h3>Cached statements, most recently used first</h3> (internal)
+        std::unordered_map<std::string,std::list<cached_statement>::iterator> statement_index_;                                     ///< <h3>Cached statements by SQL text</h3> (internal)
+        raw_buffer held_chunk_;                                                                                                     ///< <h3>First chunk of a cached select, read to check its metadata</h3> (internal)
+        std::vector<uint64_t> held_sizes_;                                                                                          ///< <h3>Block sizes of the held chunk</h3> (internal)
+        size_t held_rows_;                                                                                                          ///< <h3>Rows of the held chunk</h3> (internal)
+        bool chunk_held_;                                                                                                           ///< <h3>The next fetch() hands out the held chunk</h3> (internal)
         connector();                                                                                                                ///< <h3>Trivial constructor</h3>
         ~connector();     
         void connect_socket(const std::string &ipv4,int port,bool ssl);
         void read  (std::vector<char> &data);
+        void read  (char *data,const uint64_t data_size,const void *buffer_set=nullptr);
         void write (const char *data,const uint64_t data_size,const uint8_t msg_type[HEADER::SIZE]);
         bool connect(const std::string &ipv4,int port,bool ssl,const std::string &username,const std::string &password,const std::string &database,const std::string &service); ///< <h3>Manual connection message</h3>
         bool reconnect(const std::string &ipv4,int port,int listener_id);                                                            ///< <h3>(Load Balancer) Reconnect to a sqreamd instance</h3>
@@ -107,45 +243,123 @@ namespace sqream
         bool prepare_statement(std::string sqlQuery,int chunk_size);                                                                ///< <h3>Prepare a new sql query message</h3>
         CONSTS::statement_type metadata_query(std::vector<column> &columns_metadata_in,std::vector<column> &columns_metadata_out);  ///< <h3>Retrieve input/output metadata message</h3>
         bool execute();                                                                                                             ///< <h3>Execute statement message</h3>
-        size_t fetch(std::vector<char> &binary_data,std::vector<uint64_t> &column_sizes,size_t min_size=1);                         ///< <h3>Retrieve raw data from server message</h3>
+        bool open_prepare_statement(std::string sqlQuery,int chunk_size);                                                           ///< <h3>Open and prepare a statement in one round trip</h3>
+        CONSTS::statement_type execute_metadata_query(std::vector<column> &columns_metadata_in,std::vector<column> &columns_metadata_out);    ///< <h3>Execute a statement and retrieve its metadata in one round trip</h3>
+        CONSTS::statement_type open_prepare_execute(std::string sqlQuery,int chunk_size,std::vector<column> &columns_metadata_in,std::vector<column> &columns_metadata_out);  ///< <h3>Open, prepare, execute a statement and retrieve its metadata in one round trip</h3>
+        size_t fetch(raw_buffer &binary_data,std::vector<uint64_t> &column_sizes,size_t min_size=1);                                ///< <h3>Retrieve raw data from server message</h3>
+        void set_fetch_pipeline(uint32_t depth,uint64_t window=CONSTS::MAX_SIZE);                                                   ///< <h3>Set number of fetch requests kept in flight</h3>
+        void drain_fetches();                                                                                                       ///< <h3>Drop the replies of fetch requests in flight</h3>
+        void set_statement_cache(size_t capacity);                                                                                  ///< <h3>Set number of statements whose metadata is cached</h3>
+        void set_read_ahead(size_t bytes);                                                                                          ///< <h3>Set size of the socket read-ahead buffer</h3>
+        void set_ktls(bool enable);                                                                                                 ///< <h3>Set kernel TLS use for the sockets opened next</h3>
+        bool ktls_active();                                                                                                         ///< <h3>Kernel TLS encrypts the current connection</h3>
+        bool set_io_backend(CONSTS::io_backend backend);                                                                            ///< <h3>Set the socket transfer backend</h3>
+        CONSTS::io_backend io_backend();                                                                                            ///< <h3>Socket transfer backend in use</h3>
+        bool set_zerocopy(bool enable);                                                                                             ///< <h3>Set zero copy sending of large binary messages</h3>
+        bool zerocopy_active();                                                                                                     ///< <h3>Large binary messages are sent without being copied</h3>
+        void drop_socket_();                                                                                                        ///< <h3>Close a socket whose message stream can no longer be followed</h3> (internal)
+        void release_put_();                                                                                                        ///< <h3>Wait for the kernel to let go of the zero copy sent buffers</h3> (internal)
+        const cached_statement *find_statement_(const std::string &sqlQuery);                                                       ///< <h3>Look a statement up in the cache</h3> (internal)
+        void cache_statement_(CONSTS::statement_type type,const std::vector<column> &columns_metadata_in,const std::vector<column> &columns_metadata_out);  ///< <h3>Remember the metadata of the newest statement</h3> (internal)
+        void hold_first_chunk_(std::vector<column> &columns_metadata_out);                                                          ///< <h3>Check cached select metadata against the first chunk</h3> (internal)
+        void refresh_metadata_(std::vector<column> &columns_metadata_out);                                                          ///< <h3>Query the metadata of a statement whose cached one is stale</h3> (internal)
         void put(std::vector<char> &binary_data,size_t rows);                                                                       ///< <h3>Insert raw data to server message</h3>
+        void put(const std::vector<std::vector<std::vector<char>>> &column_blocks,size_t rows);                                     ///< <h3>Insert column blocks to server message, without flattening them</h3>
         bool close_statement();                                                                                                     ///< <h3>Close a statement message</h3>
 #undef ERR_HANDLE
 #undef ERR_HANDLE_STR
     };
+
+    /// <h3>Background fetcher keeping select chunks ready ahead of the reader</h3>
+    struct prefetcher {
+        std::unique_ptr<std::future<void>> fetch_th;                                                                                ///< <h3>Background fetch task</h3> (internal)
+        std::mutex mut_;
+        std::condition_variable cv_;
+        connector *sqc_;                                                                                                            ///< <h3>Connector the chunks are fetched from</h3> (internal)
+        const std::vector<column> *metadata_;                                                                                       ///< <h3>Output metadata the chunks are indexed with</h3> (internal)
+        size_t depth_;                                                                                                              ///< <h3>Maximum number of chunks fetched ahead</h3> (internal)
+        std::deque<result_batch> ready_;                                                                                            ///< <h3>Fetched chunks waiting to be read</h3> (internal)
+        std::vector<result_batch> spare_;                                                                                           ///< <h3>Read chunks whose buffers are recycled</h3> (internal)
+        bool done_;                                                                                                                 ///< <h3>The fetch task has ended</h3> (internal)
+        bool stop_;                                                                                                                 ///< <h3>The fetch task was asked to end</h3> (internal)
+        prefetcher();                                                                                                               ///< <h3>Constructor</h3>
+        ~prefetcher();                                                                                                              ///< <h3>Destructor</h3>
+        bool active();                                                                                                              ///< <h3>Check a fetch task was started</h3>
+        void start(connector *sqc,const std::vector<column> &metadata,size_t depth);                                                ///< <h3>Start fetching chunks in the background</h3>
+        bool next(result_batch &batch);                                                                                             ///< <h3>Swap the next fetched chunk in</h3>
+        void stop();                                                                                                                ///< <h3>End the fetch task and drop unread chunks</h3>
+        void run_();                                                                                                                ///< <h3>Body of the fetch task</h3> (internal)
+    };
+
+    struct connection_pool;
     
     /// <h3>SQream high level connector (driver)</h3>
     struct driver {
         std::unique_ptr<std::future<void>> buffer_switch_th;
         std::mutex buff_switch_mut;
+        std::condition_variable buff_switch_cv;
         std::atomic<int> curr_buff_idx;
         connector *sqc_;                                                                                                            ///< <h3>SQream low level connector pointer</h3> (internal)
+        connection_pool *pool_;                                                                                                     ///< <h3>Pool the session was checked out from, it is returned there on disconnect</h3> (internal)
         uint32_t listener_id_;
         std::string statement_;                                                                                                     ///< <h3>Newest statement</h3> (internal)
         CONSTS::statement_type statement_type_;                                                                                     ///< <h3>Newest statement type</h3> (internal)
         std::vector<column> metadata_input_;                                                                                        ///< <h3>Column metadata info for network insert</h3> (internal)
         std::vector<column> metadata_output_;                                                                                       ///< <h3>Column metadata info for select</h3> (internal)
-        std::vector<uint64_t> column_sizes_;                                                                                        ///< <h3>Retrieved column size of last fetch</h3> (internal)
-        std::vector<char> buffer_;                                                                                                  ///< <h3>Flattened data buffer</h3> (internal)
-        std::vector<std::vector<std::vector<char>>> pbuffer_[CONSTS::BUFF_COUNT];                                                                       ///< <h3>Unflattened data buffer</h3> (internal)
+        result_batch result_;                                                                                                       ///< <h3>Last fetched chunk of a select</h3> (internal)
+        prefetcher prefetch_;                                                                                                       ///< <h3>Background fetcher of select chunks</h3> (internal)
+        size_t prefetch_depth_;                                                                                                     ///< <h3>Number of chunks fetched ahead, 0 disables prefetching</h3> (internal)
+        uint32_t fetch_pipeline_;                                                                                                   ///< <h3>Fetch requests in flight applied to new connections</h3> (internal)
+        uint64_t fetch_window_;                                                                                                     ///< <h3>Fetch bytes in flight applied to new connections</h3> (internal)
+        size_t statement_cache_size_;                                                                                               ///< <h3>Statement cache capacity applied to new connections</h3> (internal)
+        size_t read_ahead_;                                                                                                         ///< <h3>Socket read-ahead buffer size applied to new connections</h3> (internal)
+        bool ktls_;                                                                                                                 ///< <h3>Kernel TLS use applied to new connections</h3> (internal)
+        CONSTS::io_backend io_backend_;                                                                                             ///< <h3>Socket transfer backend applied to new connections</h3> (internal)
+        bool zerocopy_;                                                                                                             ///< <h3>Zero copy sending applied to new connections</h3> (internal)
+        std::vector<std::vector<std::vector<std::vector<char>>>> pbuffer_;                                                          ///< <h3>Ring of unflattened data buffers</h3> (internal)
+        size_t buff_count_;                                                                                                         ///< <h3>Number of insert buffers in the ring</h3> (internal)
+        uint64_t put_budget_;                                                                                                       ///< <h3>Maximum bytes of filled buffers waiting to be sent</h3> (internal)
+        std::deque<std::pair<int,size_t>> put_queue_;                                                                               ///< <h3>Filled buffers and their row counts, in sending order</h3> (internal)
+        uint64_t queued_bytes_;                                                                                                     ///< <h3>Bytes held by the filled buffers</h3> (internal)
+        bool putting_;                                                                                                              ///< <h3>The put task is running</h3> (internal)
+        std::string put_error_;                                                                                                     ///< <h3>Error raised by the put task</h3> (internal)
         size_t row_count_;                                                                                                          ///< <h3>Rows retrieved/inserted</h3> (internal)
         size_t current_row_;                                                                                                        ///< <h3>Row that is currently manipulated by set/get functions</h3> (internal)
-        std::vector<std::array<size_t,2>> blob_shift_[CONSTS::BUFF_COUNT];                                                                              ///< <h3>Size counter of read nvarchars per row</h3> (internal)
         uint8_t state_;                                                                                                             ///< <h3>Checksum of state of the structure</h3> (internal)
         std::vector<uint8_t> colck_;                                                                                                ///< <h3>Counter for every set column</h3> (internal)
+        size_t column_batch_rows_;                                                                                                  ///< <h3>Rows of the pending column batch</h3> (internal)
+        std::unordered_map<std::string,size_t> column_names_;                                                                       ///< <h3>Column index by name of the executed statement</h3> (internal)
         driver();                                                                                                                   ///< <h3>Constructor</h3>
         ~driver();                                                                                                                  ///< <h3>Destructor</h3>
         size_t flat_size_();                                                                                                        ///< <h3>Size of flat buffer</h3> (internal)
         void init_pbuffer_(const std::vector<column> &metadata);                                                                    ///< <h3>Initializer for unflattend buffer</h3> (internal)
-        void reset_pbuffer_(const std::vector<column> &metadata);
+        void reset_pbuffer_();
         void put_buff(size_t row_cnt, int buff_idx);
-        void flatten_(std::vector<std::vector<std::vector<char>>> &buff_to_flatten);                                                                                                            ///< <h3>Copy data from unflattend buffer to flat buffer</h3> (internal)
-        void unflatten_();                                                                                                          ///< <h3>Copy data from flat buffer to unflattend buffer</h3> (internal)
+        void queue_put_(size_t row_cnt);                                                                                            ///< <h3>Hand the current buffer to the put task and move to a free one</h3> (internal)
+        void put_loop_();                                                                                                           ///< <h3>Body of the put task</h3> (internal)
+        void drain_puts_();                                                                                                         ///< <h3>Wait for the filled buffers to be sent</h3> (internal)
+        void check_typed_columns_(CONSTS::statement_type type,const typed_column *expected,const size_t count);              ///< <h3>Check the statement columns match the types of a typed cursor or appender</h3> (internal)
+        void flush_insert_();                                                                                                       ///< <h3>Hand the current insert buffer to the put task</h3> (internal)
         bool connect(const std::string &ipv4,int port,bool ssl,const std::string &username,const std::string &password,const std::string &database,const std::string &service=std::string(CONSTS::DEFAULT_SERVICE));        ///< <h3>Connect to a sqreamd instance</h3>
         void disconnect();                                                                                                          ///< <h3>Disconnect to sqreamd instance</h3>
+        void set_prefetch_depth(const size_t depth);                                                                                ///< <h3>Set number of select chunks fetched ahead in the background</h3>
+        void set_fetch_pipeline(const uint32_t depth,const uint64_t window=CONSTS::MAX_SIZE);                                       ///< <h3>Set number of fetch requests kept in flight on the wire</h3>
+        void set_statement_cache(const size_t capacity);                                                                            ///< <h3>Set number of statements whose metadata is cached per connection</h3>
+        void set_read_ahead(const size_t bytes);                                                                                    ///< <h3>Set size of the socket read-ahead buffer per connection</h3>
+        void set_ktls(const bool enable);                                                                                           ///< <h3>Set kernel TLS use for the connections made next</h3>
+        void set_io_backend(const CONSTS::io_backend backend);                                                                      ///< <h3>Set the socket transfer backend per connection</h3>
+        void set_zerocopy(const bool enable);                                                                                       ///< <h3>Set zero copy sending of the insert buffers per connection</h3>
+        void set_insert_buffers(const size_t count,const uint64_t budget=UINT64_MAX);                                               ///< <h3>Set number of insert buffers and the bytes they may hold while waiting to be sent</h3>
         void new_query(const std::string &sql_query);                                                                               ///< <h3>Create a new SQream query</h3>
         bool execute_query();                                                                                                       ///< <h3>Execute the current query</h3>
+        bool new_execute_query(const std::string &sql_query);                                                                       ///< <h3>Create and execute a new SQream query in one round trip</h3>
+        void init_statement_();                                                                                                     ///< <h3>Reset the per statement state</h3> (internal)
+        void init_buffers_();                                                                                                       ///< <h3>Prepare buffers for the executed statement type</h3> (internal)
         bool next_query_row(const size_t min_put_size=CONSTS::MIN_PUT_SIZE);                                                        ///< <h3>Move to next row</h3>
+        bool next_query_rows(const size_t min_put_size=CONSTS::MIN_PUT_SIZE);                                                       ///< <h3>Move past a batch of rows set by columns</h3>
+        void advance_insert_(const uint8_t set_by,const size_t rows,const size_t min_put_size);                                     ///< <h3>Account set rows and put the buffer when full</h3> (internal)
+        bool next_query_chunk();                                                                                                    ///< <h3>Move to next fetched chunk</h3>
+        bool fetch_chunk_();                                                                                                        ///< <h3>Fetch and index the next select chunk</h3> (internal)
         bool finish_query();                                                                                                        ///< <h3>Finish the current query</h3>
         bool is_nullable(const size_t col);                                                                                         ///< <h3>Check column is nullable by column index</h3>
         bool is_null(const size_t col);                                                                                             ///< <h3>Check nullity of selected row by column index</h3>
@@ -160,6 +374,20 @@ namespace sqream
         uint64_t get_datetime(const size_t col);                                                                                    ///< <h3>Get datetime value of selected row by column index</h3>
         std::string get_varchar(const size_t col);                                                                                  ///< <h3>Get varchar value of selected row by column index</h3>
         std::string get_nvarchar(const size_t col);                                                                                 ///< <h3>Get nvarchar value of selected row by column index</h3>
+        std::string_view get_varchar_view(const size_t col,const bool trim=false);                                                  ///< <h3>Get varchar value of selected row by column index, valid until the next chunk</h3>
+        std::string_view get_nvarchar_view(const size_t col);                                                                       ///< <h3>Get nvarchar value of selected row by column index, valid until the next chunk</h3>
+        size_t get_chunk_rows();                                                                                                    ///< <h3>Get row count of the current fetched chunk</h3>
+        std::span<const bool> get_null_column(const size_t col);                                                                    ///< <h3>Get null flags of the current chunk by column index</h3>
+        std::span<const bool> get_bool_column(const size_t col);                                                                    ///< <h3>Get boolean values of the current chunk by column index</h3>
+        std::span<const uint8_t> get_ubyte_column(const size_t col);                                                                ///< <h3>Get unsigned byte values of the current chunk by column index</h3>
+        std::span<const int16_t> get_short_column(const size_t col);                                                                ///< <h3>Get short values of the current chunk by column index</h3>
+        std::span<const int32_t> get_int_column(const size_t col);                                                                  ///< <h3>Get int values of the current chunk by column index</h3>
+        std::span<const int64_t> get_long_column(const size_t col);                                                                 ///< <h3>Get long values of the current chunk by column index</h3>
+        std::span<const float> get_float_column(const size_t col);                                                                  ///< <h3>Get float values of the current chunk by column index</h3>
+        std::span<const double> get_double_column(const size_t col);                                                                ///< <h3>Get double values of the current chunk by column index</h3>
+        std::span<const uint32_t> get_date_column(const size_t col);                                                                ///< <h3>Get date values of the current chunk by column index</h3>
+        std::span<const uint64_t> get_datetime_column(const size_t col);                                                            ///< <h3>Get datetime values of the current chunk by column index</h3>
+        size_t get_column_index(const std::string &col_name);                                                                       ///< <h3>Resolve a column name of the executed statement to a reusable column index</h3>
         bool is_nullable(const std::string &col_name);                                                                              ///< <h3>Check column is nullable by column index</h3>
         bool is_null(const std::string &col_name);                                                                                  ///< <h3>Check nullity of selected row by column name</h3>
         bool get_bool(const std::string &col_name);                                                                                 ///< <h3>Get boolean value of selected row by column name</h3>
@@ -185,20 +413,339 @@ namespace sqream
         void set_datetime(const size_t col,const uint64_t value);                                                                   ///< <h3>Set datetime value of insertion row by column index</h3>
         void set_varchar(const size_t col,const std::string &value);                                                                ///< <h3>Set varchar value of insertion row by column index</h3>
         void set_nvarchar(const size_t col,const std::string &value);                                                               ///< <h3>Set nvarchar value of insertion row by column index</h3>
-        void set_null(const std::string &col_name);                                                                                 ///< <h3>Set nullity of insertion row by column name</h3> (unsupported)
-        void set_bool(const std::string &col_name,const bool value);                                                                ///< <h3>Set boolean value of insertion row by column name</h3> (unsupported)
-        void set_ubyte(const std::string &col_name,const uint8_t value);                                                            ///< <h3>Set unsigned byte value of insertion row by column name</h3> (unsupported)
-        void set_short(const std::string &col_name,const uint16_t value);                                                           ///< <h3>Set short value of insertion row by column name</h3> (unsupported)
-        void set_int(const std::string &col_name,const uint32_t value);                                                             ///< <h3>Set int value of insertion row by column name</h3> (unsupported)
-        void set_long(const std::string &col_name,const uint64_t value);                                                            ///< <h3>Set long value of insertion row by column name</h3> (unsupported)
-        void set_float(const std::string &col_name,const float value);                                                              ///< <h3>Set float value of insertion row by column name</h3> (unsupported)
-        void set_double(const std::string &col_name,const double value);                                                            ///< <h3>Set double value of insertion row by column name</h3> (unsupported)
-        void set_date(const std::string &col_name,const uint32_t value);                                                            ///< <h3>Set date value of insertion row by column name</h3> (unsupported)
-        void set_datetime(const std::string &col_name,const uint64_t value);                                                        ///< <h3>Set datetime value of insertion row by column name</h3> (unsupported)
-        void set_varchar(const std::string &col_name,const std::string &value);                                                     ///< <h3>Set varchar value of insertion row by column name</h3> (unsupported)
-        void set_nvarchar(const std::string &col_name,const std::string &value);                                                    ///< <h3>Set nvarchar value of insertion row by column name</h3> (unsupported)
+        void set_bool_column(const size_t col,std::span<const bool> values,std::span<const bool> nulls={});                         ///< <h3>Set boolean values of a batch of insertion rows by column index</h3>
+        void set_ubyte_column(const size_t col,std::span<const uint8_t> values,std::span<const bool> nulls={});                     ///< <h3>Set unsigned byte values of a batch of insertion rows by column index</h3>
+        void set_short_column(const size_t col,std::span<const int16_t> values,std::span<const bool> nulls={});                     ///< <h3>Set short values of a batch of insertion rows by column index</h3>
+        void set_int_column(const size_t col,std::span<const int32_t> values,std::span<const bool> nulls={});                       ///< <h3>Set int values of a batch of insertion rows by column index</h3>
+        void set_long_column(const size_t col,std::span<const int64_t> values,std::span<const bool> nulls={});                      ///< <h3>Set long values of a batch of insertion rows by column index</h3>
+        void set_float_column(const size_t col,std::span<const float> values,std::span<const bool> nulls={});                       ///< <h3>Set float values of a batch of insertion rows by column index</h3>
+        void set_double_column(const size_t col,std::span<const double> values,std::span<const bool> nulls={});                     ///< <h3>Set double values of a batch of insertion rows by column index</h3>
+        void set_date_column(const size_t col,std::span<const uint32_t> values,std::span<const bool> nulls={});                     ///< <h3>Set date values of a batch of insertion rows by column index</h3>
+        void set_datetime_column(const size_t col,std::span<const uint64_t> values,std::span<const bool> nulls={});                 ///< <h3>Set datetime values of a batch of insertion rows by column index</h3>
+        void set_varchar_column(const size_t col,std::span<const std::string> values,std::span<const bool> nulls={});               ///< <h3>Set varchar values of a batch of insertion rows by column index</h3>
+        void set_nvarchar_column(const size_t col,std::span<const std::string> values,std::span<const bool> nulls={});              ///< <h3>Set nvarchar values of a batch of insertion rows by column index</h3>
+        void set_null(const std::string &col_name);                                                                                 ///< <h3>Set nullity of insertion row by column name</h3>
+        void set_bool(const std::string &col_name,const bool value);                                                                ///< <h3>Set boolean value of insertion row by column name</h3>
+        void set_ubyte(const std::string &col_name,const uint8_t value);                                                            ///< <h3>Set unsigned byte value of insertion row by column name</h3>
+        void set_short(const std::string &col_name,const uint16_t value);                                                           ///< <h3>Set short value of insertion row by column name</h3>
+        void set_int(const std::string &col_name,const uint32_t value);                                                             ///< <h3>Set int value of insertion row by column name</h3>
+        void set_long(const std::string &col_name,const uint64_t value);                                                            ///< <h3>Set long value of insertion row by column name</h3>
+        void set_float(const std::string &col_name,const float value);                                                              ///< <h3>Set float value of insertion row by column name</h3>
+        void set_double(const std::string &col_name,const double value);                                                            ///< <h3>Set double value of insertion row by column name</h3>
+        void set_date(const std::string &col_name,const uint32_t value);                                                            ///< <h3>Set date value of insertion row by column name</h3>
+        void set_datetime(const std::string &col_name,const uint64_t value);                                                        ///< <h3>Set datetime value of insertion row by column name</h3>
+        void set_varchar(const std::string &col_name,const std::string &value);                                                     ///< <h3>Set varchar value of insertion row by column name</h3>
+        void set_nvarchar(const std::string &col_name,const std::string &value);                                                    ///< <h3>Set nvarchar value of insertion row by column name</h3>
+    };
+
+    /// <h3>sqream types a C++ value type of a typed cursor column stands for</h3>
+    template<typename T> struct column_traits;
+    template<> struct column_traits<bool> { static constexpr CONSTS::column_type type=CONSTS::ftBool; static constexpr CONSTS::column_type alt_type=CONSTS::ftUnknown; static constexpr const char *name="ftBool"; };
+    template<> struct column_traits<uint8_t> { static constexpr CONSTS::column_type type=CONSTS::ftUByte; static constexpr CONSTS::column_type alt_type=CONSTS::ftUnknown; static constexpr const char *name="ftUByte"; };
+    template<> struct column_traits<int16_t> { static constexpr CONSTS::column_type type=CONSTS::ftShort; static constexpr CONSTS::column_type alt_type=CONSTS::ftUnknown; static constexpr const char *name="ftShort"; };
+    template<> struct column_traits<int32_t> { static constexpr CONSTS::column_type type=CONSTS::ftInt; static constexpr CONSTS::column_type alt_type=CONSTS::ftUnknown; static constexpr const char *name="ftInt"; };
+    template<> struct column_traits<int64_t> { static constexpr CONSTS::column_type type=CONSTS::ftLong; static constexpr CONSTS::column_type alt_type=CONSTS::ftUnknown; static constexpr const char *name="ftLong"; };
+    template<> struct column_traits<float> { static constexpr CONSTS::column_type type=CONSTS::ftFloat; static constexpr CONSTS::column_type alt_type=CONSTS::ftUnknown; static constexpr const char *name="ftFloat"; };
+    template<> struct column_traits<double> { static constexpr CONSTS::column_type type=CONSTS::ftDouble; static constexpr CONSTS::column_type alt_type=CONSTS::ftUnknown; static constexpr const char *name="ftDouble"; };
+    template<> struct column_traits<uint32_t> { static constexpr CONSTS::column_type type=CONSTS::ftDate; static constexpr CONSTS::column_type alt_type=CONSTS::ftUnknown; static constexpr const char *name="ftDate"; };
+    template<> struct column_traits<uint64_t> { static constexpr CONSTS::column_type type=CONSTS::ftDateTime; static constexpr CONSTS::column_type alt_type=CONSTS::ftUnknown; static constexpr const char *name="ftDateTime"; };
+    template<> struct column_traits<std::string_view> { static constexpr CONSTS::column_type type=CONSTS::ftBlob; static constexpr CONSTS::column_type alt_type=CONSTS::ftVarchar; static constexpr const char *name="ftBlob"; };
+    template<typename T> struct column_traits<std::optional<T>> : column_traits<T> {};
+    template<typename T> struct is_optional : std::false_type {};                                       ///< <h3>Typed column that can hold null values</h3>
+    template<typename T> struct is_optional<std::optional<T>> : std::true_type {};
+
+    /// <h3>Select row cursor whose column types are fixed at compile time</h3>
+    /// The column types are checked once against the output metadata when the cursor is made, the rows are then
+    /// decoded without any per value check. Nullable columns must be read as std::optional, varchar and nvarchar
+    /// columns as std::string_view pointing into the fetched chunk (valid until the next chunk, varchar keeps its padding).
+    template<typename ...T> struct typed_cursor {
+        typedef std::tuple<T...> row_type;                                                              ///< <h3>Decoded row</h3>
+        static constexpr size_t columns=sizeof...(T);
+        driver &drv_;                                                                                   ///< <h3>Driver the select was executed on</h3> (internal)
+        std::array<size_t,columns> width_;                                                              ///< <h3>Width of fixed size varchar columns, 0 for the others</h3> (internal)
+        std::array<const char *,columns> nulls_;                                                        ///< <h3>Null flags of the current chunk, nullptr for columns that are not nullable</h3> (internal)
+        std::array<const char *,columns> data_;                                                         ///< <h3>Data blocks of the current chunk</h3> (internal)
+        std::array<const uint64_t *,columns> offsets_;                                                  ///< <h3>Value offsets of the current chunk, nvarchar columns only</h3> (internal)
+
+        /// <i>Check the select executed on a driver yields the cursor column types</i><br>
+        typed_cursor(driver &drv) : drv_(drv) {
+            const typed_column expected[]={{column_traits<T>::type,column_traits<T>::alt_type,column_traits<T>::name,is_optional<T>::value}...};
+            drv_.check_typed_columns_(CONSTS::select,expected,columns);
+            for(size_t col=0;col<columns;col++)
+                width_[col]=drv_.metadata_output_[col].type_code==CONSTS::ftVarchar ? drv_.metadata_output_[col].size : 0;
+        }
+
+        /// <i>Move to the next row, fetching the next chunk when the current one is done</i><br>
+        /// <b>return</b>(bool):&emsp; false when the result set is exhausted
+        bool next() {
+            if(!drv_.next_query_row()) return false;
+            if(drv_.current_row_==0) {
+                for(size_t col=0;col<columns;col++) {
+                    nulls_[col]=drv_.metadata_output_[col].nullable ? drv_.result_.null_block(col) : nullptr;
+                    data_[col]=drv_.result_.data_block(col);
+                    offsets_[col]=drv_.result_.columns[col].value_offsets.data();
+                }
+            }
+            return true;
+        }
+
+        /// <b>return</b>:&emsp; value of column I of the current row
+        template<size_t I> std::tuple_element_t<I,row_type> get() const {
+            typedef std::tuple_element_t<I,row_type> value_type;
+            const size_t row=drv_.current_row_;
+            if constexpr(is_optional<value_type>::value) {
+                if(nulls_[I] and nulls_[I][row]) return std::nullopt;
+                return value_<typename value_type::value_type>(I,row);
+            }
+            else return value_<value_type>(I,row);
+        }
+
+        /// <b>return</b>(row_type):&emsp; every value of the current row
+        row_type row() const { return row_(std::index_sequence_for<T...>()); }
+
+        template<typename V> V value_(const size_t col,const size_t row) const {
+            if constexpr(std::is_same_v<V,std::string_view>) {
+                if(width_[col]) return std::string_view(data_[col]+width_[col]*row,width_[col]);
+                return std::string_view(data_[col]+offsets_[col][row],offsets_[col][row+1]-offsets_[col][row]);
+            }
+            else {
+                V value;
+                memcpy(&value,data_[col]+sizeof(V)*row,sizeof(V));
+                return value;
+            }
+        }
+        template<size_t ...I> row_type row_(std::index_sequence<I...>) const { return row_type(get<I>()...); }
+    };
+
+    /// <h3>Network insert row appender whose column types are fixed at compile time</h3>
+    /// The column types are checked once against the input metadata when the appender is made, rows are then written
+    /// straight into the insert buffer blocks without per column bookkeeping. Nullable columns, and only those, are
+    /// given as std::optional, varchar and nvarchar values as std::string_view. Rows set by the driver setters must be
+    /// complete before a row is appended.
+    template<typename ...T> struct typed_appender {
+        typedef std::tuple<T...> row_type;                                                              ///< <h3>Row to append</h3>
+        static constexpr size_t columns=sizeof...(T);
+        driver &drv_;                                                                                   ///< <h3>Driver the insert was executed on</h3> (internal)
+        std::array<size_t,columns> width_;                                                              ///< <h3>Width of fixed size varchar columns, 0 for the others</h3> (internal)
+        size_t buffered_;                                                                               ///< <h3>Bytes held by the current insert buffer</h3> (internal)
+        size_t rows_;                                                                                   ///< <h3>Rows of the current insert buffer when buffered_ was last counted</h3> (internal)
+
+        /// <i>Check the insert executed on a driver takes the appender column types</i><br>
+        typed_appender(driver &drv) : drv_(drv) {
+            const typed_column expected[]={{column_traits<T>::type,column_traits<T>::alt_type,column_traits<T>::name,is_optional<T>::value}...};
+            drv_.check_typed_columns_(CONSTS::insert,expected,columns);
+            for(size_t col=0;col<columns;col++)
+                width_[col]=drv_.metadata_input_[col].type_code==CONSTS::ftVarchar ? drv_.metadata_input_[col].size : 0;
+            buffered_=drv_.flat_size_();
+            rows_=drv_.row_count_;
+        }
+
+        /// <i>Append a row, the insert buffer is handed to the put task once it holds at least min_put_size bytes</i><br>
+        /// <b>input:</b>
+        /// <ul>
+        /// <li>const row_type &row:&emsp; value of every column</li>
+        /// <li>const size_t min_put_size:&emsp; minimal size of the binary data block to be sent</li>
+        /// </ul>
+        /// The buffer is counted again when the driver setters added rows to it, and before and after it is flushed.
+        void append(const row_type &row,const size_t min_put_size=CONSTS::MIN_PUT_SIZE) {
+            if(drv_.state_!=3 or drv_.statement_type_!=CONSTS::insert) throw std::string("typed_appender: no insert is being executed on the driver");
+            for(uint8_t set:drv_.colck_) if(set) throw std::string("typed_appender: the row set by the driver setters is not complete");
+            if(drv_.row_count_!=rows_) buffered_=drv_.flat_size_();
+            append_(drv_.pbuffer_[drv_.curr_buff_idx.load()].data(),row,std::index_sequence_for<T...>());
+            rows_=++drv_.row_count_;
+            if(buffered_>=min_put_size and (buffered_=drv_.flat_size_())>=min_put_size) {
+                drv_.flush_insert_();
+                buffered_=drv_.flat_size_();
+                rows_=drv_.row_count_;
+            }
+        }
+
+        template<size_t ...I> void append_(std::vector<std::vector<char>> *blocks,const row_type &row,std::index_sequence<I...>) {
+            // a row is either written whole or not at all
+            if(!(fits_<I>(std::get<I>(row)) and ...)) throw std::string("typed_appender: string size is bigger than column varchar size");
+            (column_<I>(blocks[I],std::get<I>(row)),...);
+        }
+        template<size_t I,typename V> bool fits_(const V &value) const {
+            if constexpr(std::is_same_v<V,std::string_view>) return !width_[I] or value.size()<=width_[I];
+            else if constexpr(std::is_same_v<V,std::optional<std::string_view>>) return !value or fits_<I>(*value);
+            else return true;
+        }
+        template<size_t I,typename V> void column_(std::vector<std::vector<char>> &blocks,const V &value) {
+            if constexpr(is_optional<V>::value) {
+                const char null=!value.has_value();
+                blocks[0].push_back(null);
+                buffered_++;
+                if(null) value_<I,typename V::value_type>(blocks,1,nullptr);
+                else value_<I,typename V::value_type>(blocks,1,&*value);
+            }
+            else value_<I,V>(blocks,0,&value);
+        }
+        template<size_t I,typename V> void value_(std::vector<std::vector<char>> &blocks,const size_t id,const V *value) {
+            std::vector<char> &data=blocks[id];
+            if constexpr(std::is_same_v<V,std::string_view>) {
+                const std::string_view text=value ? *value : std::string_view();
+                if(width_[I]) {
+                    data.insert(data.end(),text.begin(),text.end());
+                    data.insert(data.end(),width_[I]-text.size(),' ');
+                    buffered_+=width_[I];
+                }
+                else {
+                    const int32_t size=(int32_t)text.size();
+                    blocks[id].insert(blocks[id].end(),(const char *)&size,(const char *)&size+sizeof(size));
+                    blocks[id+1].insert(blocks[id+1].end(),text.begin(),text.end());
+                    buffered_+=sizeof(size)+text.size();
+                }
+            }
+            else {
+                const size_t offset=data.size();
+                data.resize(offset+sizeof(V));
+                if(value) memcpy(data.data()+offset,value,sizeof(V));
+                else memset(data.data()+offset,0,sizeof(V));
+                buffered_+=sizeof(V);
+            }
+        }
     };
 
+    /// <h3>Bulk loader spreading network insert batches over several connections</h3>
+    struct parallel_loader {
+        std::vector<std::unique_ptr<driver>> sessions_;                                                                             ///< <h3>One driver per connection</h3> (internal)
+        std::mutex mut_;
+        std::string error_;                                                                                                         ///< <h3>First error raised by a session</h3> (internal)
+        std::atomic<bool> failed_;                                                                                                  ///< <h3>A session failed, the others stop loading</h3> (internal)
+        std::atomic<uint64_t> rows_;                                                                                                ///< <h3>Rows set by the batch callbacks</h3> (internal)
+        uint64_t bytes_;                                                                                                            ///< <h3>Binary bytes sent by the last load</h3> (internal)
+        uint64_t base_bytes_;                                                                                                       ///< <h3>Bytes the connections had sent before the load began</h3> (internal)
+        bool started_;                                                                                                              ///< <h3>An insert statement is open on every session</h3> (internal)
+        std::chrono::steady_clock::time_point start_;                                                                               ///< <h3>Time the load began</h3> (internal)
+        std::chrono::steady_clock::time_point end_;                                                                                 ///< <h3>Time the load finished</h3> (internal)
+        parallel_loader(const size_t sessions);                                                                                     ///< <h3>Constructor</h3>
+        ~parallel_loader();                                                                                                         ///< <h3>Destructor</h3>
+        bool connect(const std::string &ipv4,int port,bool ssl,const std::string &username,const std::string &password,const std::string &database,const std::string &service=std::string(CONSTS::DEFAULT_SERVICE));        ///< <h3>Connect every session to a sqreamd instance</h3>
+        void disconnect();                                                                                                          ///< <h3>Disconnect every session</h3>
+        void begin(const std::string &sql_query);                                                                                   ///< <h3>Execute the insert statement on every session</h3>
+        void load(const size_t batches,const std::function<size_t(driver &,size_t)> &fill);                                         ///< <h3>Set batches of rows, spread over the sessions</h3>
+        void finish();                                                                                                              ///< <h3>Send the remaining rows and close the statement on every session</h3>
+        size_t sessions();                                                                                                          ///< <h3>Number of sessions</h3>
+        driver &session(const size_t idx);                                                                                          ///< <h3>Driver of a session by index</h3>
+        uint64_t rows();                                                                                                            ///< <h3>Rows loaded so far</h3>
+        uint64_t bytes();                                                                                                           ///< <h3>Binary bytes sent so far</h3>
+        double seconds();                                                                                                           ///< <h3>Time spent loading</h3>
+        double rows_per_second();                                                                                                   ///< <h3>Aggregate row throughput</h3>
+        double bytes_per_second();                                                                                                  ///< <h3>Aggregate byte throughput</h3>
+        void fail_(const size_t idx,const std::string &err);                                                                        ///< <h3>Record the error of a session</h3> (internal)
+        void abandon_();                                                                                                            ///< <h3>Drop every session after a failure and raise the error</h3> (internal)
+        uint64_t sent_bytes_();                                                                                                     ///< <h3>Bytes sent by every connection</h3> (internal)
+    };
+
+    /// <h3>Thread-safe pool of connected and authenticated connector sessions</h3>
+    struct connection_pool {
+        std::mutex mut_;
+        std::condition_variable cv_;
+        std::string ipv4_;                                                                                                          ///< <h3>ipv4 address of sqreamd</h3> (internal)
+        int port_;                                                                                                                  ///< <h3>Port of sqreamd</h3> (internal)
+        bool ssl_;                                                                                                                  ///< <h3>Connect with SSL sessions</h3> (internal)
+        std::string username_;
+        std::string password_;
+        std::string database_;
+        std::string service_;
+        size_t min_;                                                                                                                ///< <h3>Sessions kept open even when idle</h3> (internal)
+        size_t max_;                                                                                                                ///< <h3>Most sessions open at once</h3> (internal)
+        std::chrono::milliseconds idle_timeout_;                                                                                    ///< <h3>Idle time after which sessions above min_ are closed</h3> (internal)
+        std::deque<std::pair<connector *,std::chrono::steady_clock::time_point>> idle_;                                             ///< <h3>Idle sessions and the time they were returned, oldest first</h3> (internal)
+        size_t open_;                                                                                                               ///< <h3>Sessions open, idle or checked out, or being connected</h3> (internal)
+        std::vector<driver *> lent_;                                                                                                ///< <h3>Drivers holding a checked out session</h3> (internal)
+        connection_pool(const std::string &ipv4,int port,bool ssl,const std::string &username,const std::string &password,const std::string &database,const std::string &service=std::string(CONSTS::DEFAULT_SERVICE),size_t min_sessions=1,size_t max_sessions=8,std::chrono::milliseconds idle_timeout=std::chrono::seconds(60));    ///< <h3>Constructor, opens min_sessions sessions</h3>
+        ~connection_pool();                                                                                                         ///< <h3>Destructor, closes the idle sessions</h3>
+        void checkout(driver &drv,std::chrono::milliseconds timeout=std::chrono::seconds(30));                                      ///< <h3>Hand a healthy session to a driver</h3>
+        void checkin(driver &drv);                                                                                                  ///< <h3>Take the session of a driver back</h3>
+        void warm();                                                                                                                ///< <h3>Open sessions up to the minimum</h3>
+        void evict_idle();                                                                                                          ///< <h3>Close sessions above the minimum that idled too long</h3>
+        size_t size();                                                                                                              ///< <h3>Number of open sessions</h3>
+        size_t idle();                                                                                                              ///< <h3>Number of idle sessions</h3>
+        connector *open_session_();                                                                                                 ///< <h3>Connect a new session</h3> (internal)
+        void evict_expired_(std::unique_lock<std::mutex> &lock);                                                                    ///< <h3>Close expired idle sessions, with the lock held</h3> (internal)
+        void drop_(connector *conn,bool healthy);                                                                                   ///< <h3>Close a session that leaves the pool</h3> (internal)
+    };
+
+#ifdef __linux__
+    /// <h3>Completion of an asynchronous execute, with the metadata of the executed statement</h3>
+    typedef std::function<void(const std::string &error,CONSTS::statement_type type,std::vector<column> &metadata_in,std::vector<column> &metadata_out)> execute_callback;
+    /// <h3>Completion of an asynchronous fetch, 0 rows once the result set is exhausted</h3>
+    typedef std::function<void(const std::string &error,size_t rows,raw_buffer &binary_data,std::vector<uint64_t> &column_sizes)> fetch_callback;
+    /// <h3>Completion of an asynchronous put</h3>
+    typedef std::function<void(const std::string &error)> put_callback;
+
+    /// <h3>Request of an attached connection waiting to be sent or answered</h3> (internal)
+    struct async_operation {
+        enum kind_t:char { execute,fetch,put } kind;                                                                                ///< <h3>Protocol exchange</h3>
+        std::vector<char> request;                                                                                                  ///< <h3>Framed messages to send</h3>
+        std::vector<char> payload;                                                                                                  ///< <h3>Binary put data sent after the request</h3>
+        size_t sent=0;                                                                                                              ///< <h3>Bytes of request and payload sent</h3>
+        size_t replies=0;                                                                                                           ///< <h3>Replies received</h3>
+        CONSTS::statement_type type=CONSTS::statement_type::unset;                                                                  ///< <h3>Executed statement type</h3>
+        std::vector<column> metadata_in;                                                                                            ///< <h3>Input columns of an executed insert</h3>
+        std::vector<column> metadata_out;                                                                                           ///< <h3>Output columns of an executed select</h3>
+        size_t rows=0;                                                                                                              ///< <h3>Rows of a fetched chunk</h3>
+        raw_buffer binary_data;                                                                                                     ///< <h3>Fetched chunk</h3>
+        std::vector<uint64_t> column_sizes;                                                                                         ///< <h3>Block sizes of the fetched chunk</h3>
+        std::string error;                                                                                                          ///< <h3>Error reported by sqreamd</h3>
+        execute_callback executed;
+        fetch_callback fetched;
+        put_callback putted;
+    };
+
+    /// <h3>Connection attached to a reactor</h3> (internal)
+    struct async_session {
+        connector *conn;                                                                                                            ///< <h3>Attached connection, in non-blocking mode</h3>
+        std::deque<async_operation> incoming;                                                                                       ///< <h3>Submitted requests not yet seen by the loop</h3> (guarded by the loop mutex)
+        std::deque<async_operation> operations;                                                                                     ///< <h3>Requests being sent or waiting for replies, in order</h3>
+        size_t send_idx=0;                                                                                                          ///< <h3>First operation not completely sent</h3>
+        char header[10];                                                                                                            ///< <h3>Header of the message being received</h3>
+        size_t header_got=0;                                                                                                        ///< <h3>Header bytes received</h3>
+        char *body=nullptr;                                                                                                         ///< <h3>Where the body of the message being received goes</h3>
+        uint64_t body_size=0;                                                                                                       ///< <h3>Body size of the message being received</h3>
+        uint64_t body_got=0;                                                                                                        ///< <h3>Body bytes received</h3>
+        std::vector<char> reply;                                                                                                    ///< <h3>Body of JSON replies</h3>
+        bool writing=false;                                                                                                         ///< <h3>Waiting for the socket to become writable</h3>
+        std::string broken;                                                                                                         ///< <h3>Reason the connection became unusable</h3>
+        bool detaching=false;                                                                                                       ///< <h3>detach() waits for the session</h3> (guarded by the loop mutex)
+        bool detached=false;                                                                                                        ///< <h3>The loop let go of the session</h3> (guarded by the loop mutex)
+    };
+
+    /// <h3>Event loop thread of a reactor</h3> (internal)
+    struct async_loop {
+        int epoll_fd=-1;                                                                                                            ///< <h3>Readiness of the attached sockets</h3>
+        int wake_fd=-1;                                                                                                             ///< <h3>eventfd waking the loop for new requests</h3>
+        std::mutex mut;
+        std::condition_variable cv;                                                                                                 ///< <h3>Signals detached sessions</h3>
+        std::vector<async_session*> sessions;                                                                                       ///< <h3>Attached sessions</h3> (guarded by mut)
+        bool stop=false;                                                                                                            ///< <h3>The reactor is shutting down</h3> (guarded by mut)
+        std::future<void> thread;
+    };
+
+    /// <h3>epoll reactor running execute/fetch/put of many connections on a few threads</h3>
+    struct reactor {
+        std::vector<std::unique_ptr<async_loop>> loops_;                                                                            ///< <h3>Event loops, each on its own thread</h3> (internal)
+        std::mutex mut_;
+        std::unordered_map<connector*,std::pair<async_loop*,async_session*>> attached_;                                             ///< <h3>Loop and session of every attached connection</h3> (internal)
+        reactor(size_t threads=1);                                                                                                  ///< <h3>Constructor, starts the loop threads</h3>
+        ~reactor();                                                                                                                 ///< <h3>Destructor, fails pending requests and detaches every connection</h3>
+        void attach(connector &conn);                                                                                               ///< <h3>Hand a connection with a prepared statement to the reactor</h3>
+        void detach(connector &conn);                                                                                               ///< <h3>Wait for the requests of a connection and give it back in blocking mode</h3>
+        void execute(connector &conn,execute_callback done);                                                                        ///< <h3>Execute the prepared statement and retrieve its metadata</h3>
+        void fetch(connector &conn,fetch_callback done);                                                                            ///< <h3>Retrieve the next chunk of a select</h3>
+        void put(connector &conn,std::vector<char> &&binary_data,size_t rows,put_callback done);                                    ///< <h3>Insert serialized rows</h3>
+        void submit_(connector &conn,async_operation &&op);                                                                         ///< <h3>Queue a request on the loop of its connection</h3> (internal)
+        void run_(async_loop &loop);                                                                                                ///< <h3>Body of a loop thread</h3> (internal)
+        void pump_(async_loop &loop,async_session &session);                                                                        ///< <h3>Move whatever the socket of a session is ready for</h3> (internal)
+        void send_(async_session &session);                                                                                         ///< <h3>Send pending requests until the socket is full</h3> (internal)
+        void receive_(async_session &session);                                                                                      ///< <h3>Receive replies until the socket is empty</h3> (internal)
+        bool reply_(async_session &session,async_operation &op);                                                                    ///< <h3>Handle a complete reply to the oldest request</h3> (internal)
+        void complete_(async_session &session);                                                                                     ///< <h3>Retire the oldest request and call its completion</h3> (internal)
+        void fail_(async_session &session,const std::string &error);                                                                ///< <h3>Mark a session unusable and fail its requests</h3> (internal)
+    };
+#endif
+
     ///< <h3>SQream date conversion structure</h3>
     struct date_t {
         int32_t year;                                                                                                               ///< <h3>Year value</h3>
@@ -3,6 +3,10 @@
 #include <string>
 // #include <tuple>
 #include <memory>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
 
 #include <errno.h>
 #include <openssl/ssl.h>
@@ -32,6 +36,20 @@
     #include <netinet/in.h>
     #include <stdarg.h>
     #include <sys/ioctl.h>
+    #include <sys/uio.h>    // sendmsg(), struct iovec
+    #include <fcntl.h>      // fcntl(), O_NONBLOCK
+    #include <sys/mman.h>   // mmap() of the io_uring rings
+    #include <sys/syscall.h>
+    #include <linux/io_uring.h>
+    #include <linux/errqueue.h> // MSG_ZEROCOPY completions
+    #include <poll.h>
+
+    #ifndef SO_ZEROCOPY
+        #define SO_ZEROCOPY     60
+    #endif
+    #ifndef MSG_ZEROCOPY
+        #define MSG_ZEROCOPY    0x4000000
+    #endif
 
     #define PHOSTENT hostent*
     #define SOCKET unsigned int
@@ -40,6 +58,23 @@
     #define SOCKET_ERROR            (-1)
 #endif
 
+#define SOCK_MAX_IOV            1024            // most buffers handed to a single sendmsg call (UIO_MAXIOV)
+#define SOCK_SSL_RECORD         16384           // largest TLS record payload, small buffers are packed up to it
+#define SOCK_READ_AHEAD         65536           // default read-ahead buffer, reads this large or larger bypass it
+
+// transfer backends, see SockSetBackend
+#define SOCK_BACKEND_BLOCKING   0               // send/recv system calls (default)
+#define SOCK_BACKEND_IO_URING   1               // io_uring submissions, plain sockets on Linux only
+#define SOCK_RING_ENTRIES       64              // io_uring submission queue size, most buffers in one submission
+#define SOCK_REG_SETS           16              // most buffer sets kept registered with io_uring
+#define SOCK_ZEROCOPY_WAIT      30000           // ms waited for the kernel to release zero copy buffers
+
+// results of the non-blocking SockSendSome / SockRecvSome
+#define SOCK_IO_DONE            0               // some bytes moved
+#define SOCK_IO_WOULD_BLOCK     1               // nothing can move before the socket is ready again
+#define SOCK_IO_CLOSED          2               // the peer closed the connection
+#define SOCK_IO_ERROR           3               // the connection failed
+
 // ---------------------------- develop print related -----------------
 #define ping puts("ping");
 #define puts(str) puts(str);
@@ -49,13 +84,59 @@
 struct ssl_st;
 typedef struct ssl_st SSL;
 
+struct TSockChunk {
+        const void*     pBuffer;                        // start of the buffer
+        size_t          pChunkSize;                     // bytes to write from it
+};
+
+#ifdef __linux__
+// io_uring instance of a socket, rings mapped from the kernel
+struct TSockRing {
+        int             fd = -1;
+        unsigned        entries = 0;
+        void*           sq_map = MAP_FAILED;            // submission ring
+        size_t          sq_map_size = 0;
+        void*           cq_map = MAP_FAILED;            // completion ring, may be the same mapping
+        size_t          cq_map_size = 0;
+        io_uring_sqe*   sqes = (io_uring_sqe*)MAP_FAILED;
+        size_t          sqes_size = 0;
+        unsigned        *sq_head, *sq_tail, *sq_mask, *sq_array;
+        unsigned        *cq_head, *cq_tail, *cq_mask;
+        io_uring_cqe*   cqes;
+
+        bool            registered = false;             // buffers registered with the kernel
+        bool            register_failed = false;        // registering was refused (e.g. RLIMIT_MEMLOCK), not tried again
+        std::vector<std::pair<const void*, std::vector<iovec>>> sets;      // registered buffer sets and their owner, newest last
+};
+#else
+struct TSockRing {};
+#endif
+
 struct TSocketClient {
 
 public:
         bool            SockCreateAndConnect    ( void );                                                                 // create and connect via socket    
         bool            SockWriteChunk          ( const void* pBuffer, size_t pChunkSize, int& pBytesWritten );              // write a chunk to socket
-        bool            SockReadChunk           ( char* pBuffer, int& pBytesRead, int pChunkSize );                       // read a chunk from socket 
+        bool            SockWriteChunks         ( const TSockChunk* pChunks, size_t pChunkCount, size_t& pBytesWritten, const void* pSet = NULL, bool pZeroCopy = false );    // write several buffers to socket in one go
+        bool            SockReadChunk           ( char* pBuffer, int& pBytesRead, int pChunkSize, const void* pSet = NULL );   // read a chunk from socket 
         void            SockClose               ( void );           // closes the existing open socket if any    
+        bool            SockIsAlive             ( void );           // checks an idle socket was not closed by the peer
+        void            SockSetReadAhead        ( size_t pSize );   // resize the read-ahead buffer, 0 reads straight from the socket
+        bool            SockSessionReused       ( void );           // the TLS handshake resumed an earlier session
+        void            SockEnableKtls          ( bool pEnable );   // ask for kernel TLS on the next connect (Linux, opt-in)
+        bool            SockKtlsActive          ( void );           // the kernel encrypts what is sent on this connection
+        bool            SockSetNonBlocking      ( bool pNonBlocking );                                                    // switch between blocking and non-blocking io
+        int             SockSendSome            ( const void* pBuffer, size_t pSize, size_t& pBytesWritten );             // non-blocking write of up to pSize bytes
+        int             SockRecvSome            ( char* pBuffer, size_t pSize, size_t& pBytesRead );                      // non-blocking read of up to pSize bytes
+        int             SockHandle              ( void );           // descriptor to wait on for readiness
+        bool            SockSetBackend          ( int pBackend );   // pick SOCK_BACKEND_*, false when it is not available here
+        int             SockBackend             ( void );           // SOCK_BACKEND_* in use
+        bool            SockRegisterBuffers     ( const void* pSet, const TSockChunk* pBuffers, size_t pCount );   // register a set of buffers with io_uring
+        void            SockUnregisterBuffers   ( void );           // forget every registered set, before their memory is freed
+        bool            SockEnableZeroCopy      ( bool pEnable );   // let SockWriteChunks send with MSG_ZEROCOPY, false when not available here
+        bool            SockZeroCopyActive      ( void );           // zero copy sends are in use
+        uint32_t        SockZeroCopySent        ( void );           // mark after the zero copy sends made so far
+        bool            SockZeroCopyWait        ( uint32_t pMark ); // wait until the kernel released the buffers sent before the mark
 
         TSocketClient   ( const char* pServer, int pPort , bool is_ssl_ );   // constructor
         ~TSocketClient  ();                                                  // destructor       
@@ -66,13 +147,44 @@ private:
         struct sockaddr_in  vSockAddr;                  // sockaddr details
         SSL *ssl;
         bool is_ssl;
+        bool            vKtls;                          // kernel TLS requested
+        bool            vKtlsSend;                      // kernel TLS in use for sending, writes bypass SSL_write
+        bool            vNonBlocking;                   // driven by readiness, receives bypass the io_uring
+        // MSG_ZEROCOPY sends are numbered by the kernel, [vZcDone, vZcNext) still pin their buffers
+        bool            vZeroCopy;
+        uint32_t        vZcNext;
+        uint32_t        vZcDone;
+        std::vector<std::pair<uint32_t, uint32_t>> vZcRanges;  // completed ranges past vZcDone
+        // read-ahead buffer, bytes [vReadPos, vReadEnd) are received but not yet consumed
+        std::unique_ptr<char[]> vReadBuf;
+        size_t          vReadSize;
+        size_t          vReadPos;
+        size_t          vReadEnd;
         // other data members
         char vszErrMsg[256];                     // last error msg
 
         // private function members
         bool    SetErrMsg               ( bool flgIncludeWin32Error, const char* pszErrMsg, ... );
         ssize_t sock_send(const char *buf, sock_buf_size buf_size);
+        ssize_t sock_sendv(const TSockChunk *chunks, size_t count, size_t skip, int flags = 0);
         ssize_t sock_recv(char *buf, sock_buf_size buf_size);
+        bool    sock_recv_all(char *buf, size_t buf_size, const void* set = NULL);
+        uint64_t sock_peer_key(void);
+        int     sock_io_status(ssize_t result, bool through_ssl);
+        bool    zc_reap(void);
+
+        // io_uring backend
+        std::unique_ptr<TSockRing> vRing;               // set while the io_uring backend is in use
+        void    ring_close(void);
+        int     ring_fixed(const void* set, const void* buf, size_t buf_size);
+        ssize_t ring_sendv(const TSockChunk *chunks, size_t count, size_t skip, const void* set);
+        ssize_t ring_recv(char *buf, size_t buf_size, int flags, const void* set);
+
+        // TLS state shared by every client of the process
+        static  std::mutex                      g_mtxSslSessions;       // guards g_mapSslSessions
+        static  std::map<uint64_t, SSL_SESSION*> g_mapSslSessions;      // newest resumable session per server address and port
+        static  SSL_CTX*    sock_ssl_ctx            (void);
+        static  int         sock_ssl_new_session    (SSL* pSsl, SSL_SESSION* pSession);
         
 public:
         // static data members
@@ -88,6 +200,8 @@ public:
 
 ssize_t TSocketClient::sock_recv (char *buf, sock_buf_size buf_size) {
 
+    if (vRing and !vNonBlocking)
+        return ring_recv(buf, buf_size, 0, NULL);
     return (is_ssl) ? SSL_read(ssl, buf, buf_size) : recv(vSocket, buf, buf_size, 0);
 }
 
@@ -96,8 +210,93 @@ ssize_t TSocketClient::sock_send(const char *buf, sock_buf_size buf_size) {
         return (is_ssl) ? SSL_write(ssl, buf, buf_size) : send(vSocket, buf, buf_size, 0);
 }
 
+// --------------------------------------------------------------------
+// gathers up to SOCK_MAX_IOV buffers into one send, skipping the first
+// 'skip' bytes of chunks[0] which an earlier partial send already wrote
+// --------------------------------------------------------------------
+ssize_t TSocketClient::sock_sendv(const TSockChunk *chunks, size_t count, size_t skip, int flags) {
+
+#ifdef __linux__
+    struct iovec iov[SOCK_MAX_IOV];
+    struct msghdr msg;
+    size_t n = 0;
+
+    for (; n < count and n < SOCK_MAX_IOV; n++) {
+        iov[n].iov_base = (char*)chunks[n].pBuffer + (n ? 0 : skip);
+        iov[n].iov_len  = chunks[n].pChunkSize - (n ? 0 : skip);
+    }
+    memset (&msg, 0, sizeof(msg));
+    msg.msg_iov    = iov;
+    msg.msg_iovlen = n;
+
+    return sendmsg(vSocket, &msg, MSG_NOSIGNAL | flags);
+#else
+    return sock_send((const char*)chunks[0].pBuffer + skip, chunks[0].pChunkSize - skip);
+#endif
+}
+
 // ----------------- static data members initialization ------------------
+#ifdef __linux__
+bool TSocketClient::g_flgLibReady = 1;                  // nothing to initialize, set once so concurrent clients never write it
+#else
 bool TSocketClient::g_flgLibReady = 0;
+#endif
+std::mutex                       TSocketClient::g_mtxSslSessions;
+std::map<uint64_t, SSL_SESSION*> TSocketClient::g_mapSslSessions;
+
+// --------------------------------------------------------------------
+// STATIC, the TLS client context shared by every connection, created
+// on first use; it is never freed since sessions may outlive clients
+// --------------------------------------------------------------------
+
+SSL_CTX* TSocketClient::sock_ssl_ctx (void) {
+
+    static SSL_CTX* ctx = [] {
+        SSL_library_init();
+        SSL_load_error_strings();
+        OpenSSL_add_all_algorithms();
+
+        SSL_CTX* c = SSL_CTX_new( SSLv23_client_method());
+        if (c) {
+            SSL_CTX_set_options (c, SSL_OP_SINGLE_DH_USE | SSL_OP_NO_SSLv2);
+            // sessions are kept per server in g_mapSslSessions, handed over by sock_ssl_new_session
+            SSL_CTX_set_session_cache_mode (c, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_sess_set_new_cb (c, sock_ssl_new_session);
+        }
+        return c;
+    }();
+
+    return ctx;
+}
+
+// --------------------------------------------------------------------
+// STATIC, keeps the newest session (ID or ticket) a server handed out,
+// so the next connection to it can use an abbreviated handshake
+// --------------------------------------------------------------------
+
+int TSocketClient::sock_ssl_new_session (SSL* pSsl, SSL_SESSION* pSession) {
+
+    TSocketClient* client = (TSocketClient*)SSL_get_app_data (pSsl);
+    if (client == NULL)
+        return 0;                                       // not kept, OpenSSL frees it
+
+    std::lock_guard<std::mutex> lock (g_mtxSslSessions);
+    SSL_SESSION*& slot = g_mapSslSessions[client->sock_peer_key()];
+    if (slot)
+        SSL_SESSION_free (slot);
+    slot = pSession;
+
+    return 1;                                           // the reference is ours now
+}
+
+// --------------------------------------------------------------------
+// server address and port, the key sessions are kept under
+// --------------------------------------------------------------------
+
+uint64_t TSocketClient::sock_peer_key (void) {
+
+    return ((uint64_t)vSockAddr.sin_addr.s_addr << 16) | vSockAddr.sin_port;
+}
 
 // --------------------------------------------------------------------
 // does the work of the constructor, initializes addr struct with IP and port
@@ -113,6 +312,12 @@ typedef unsigned int in_addr_t;
 TSocketClient::TSocketClient (const char* pServer, int pPort, bool is_ssl_) : is_ssl(is_ssl_) {
 
     vSocket = INVALID_SOCKET;                          // handle
+    vKtls = vKtlsSend = false;                         // kernel TLS is opt-in
+    vNonBlocking = false;
+    vZeroCopy = false;                                  // zero copy is opt-in
+    vZcNext = vZcDone = 0;
+    vReadSize = vReadPos = vReadEnd = 0;               // read-ahead buffer
+    SockSetReadAhead (SOCK_READ_AHEAD);
     memset (&vSockAddr, 0, sizeof(vSockAddr));         // address struct
     memset (vszErrMsg, 0, sizeof(vszErrMsg));          // internal error message store
     auto error = false;
@@ -161,15 +366,6 @@ TSocketClient::TSocketClient (const char* pServer, int pPort, bool is_ssl_) : is
     vSockAddr.sin_family    =  AF_INET;                 // address family
     vSockAddr.sin_port      =  htons ( (uint16_t)pPort );         // port number
 
-#ifdef __linux__
-    g_flgLibReady = true;
-#endif
-    if (is_ssl) {
-        SSL_library_init();
-        SSL_load_error_strings();
-        OpenSSL_add_all_algorithms();        
-    }
-
 }
 
 
@@ -274,18 +470,39 @@ bool TSocketClient::SockCreateAndConnect ( void ) {
     
     // SSL
     if (is_ssl) {
-        SSL_CTX * sslctx = SSL_CTX_new( SSLv23_client_method());
-        SSL_CTX_set_options (sslctx, SSL_OP_SINGLE_DH_USE | SSL_OP_NO_SSLv2);
-        ssl = SSL_new(sslctx);
+        SSL_CTX * sslctx = sock_ssl_ctx();
+        ssl = sslctx ? SSL_new(sslctx) : NULL;
+        if (ssl == NULL) {
+            is_ssl = false;
+            SetErrMsg ( false, "could not create ssl context\n ");
+            return false;
+        }
         SSL_set_fd(ssl, (int)vSocket );
-        
-        if (SSL_connect(ssl) == -1) {
+        SSL_set_app_data(ssl, this);
+#ifdef SSL_OP_ENABLE_KTLS
+        if (vKtls)
+            SSL_set_options(ssl, SSL_OP_ENABLE_KTLS);   // OpenSSL silently stays in user space if the kernel or cipher can't do it
+#endif
+
+        // offer the last session of this server for resumption
+        {
+            std::lock_guard<std::mutex> lock (g_mtxSslSessions);
+            auto found = g_mapSslSessions.find (sock_peer_key());
+            if (found != g_mapSslSessions.end())
+                SSL_set_session (ssl, found->second);
+        }
+
+        if (SSL_connect(ssl) <= 0) {
             is_ssl = false;
+            SSL_set_app_data(ssl, NULL);
             SSL_shutdown(ssl);
             SSL_free(ssl);
             SetErrMsg ( true, "server doesn't work in ssl mode\n ");
             return false;
         }
+#if defined(__linux__) && defined(SSL_OP_ENABLE_KTLS)
+        vKtlsSend = vKtls and BIO_get_ktls_send(SSL_get_wbio(ssl));
+#endif
     } 
 
     return true;
@@ -329,14 +546,164 @@ bool TSocketClient::SockWriteChunk (const void* pBuffer, size_t pChunkSize, int&
     return true;
 }
 
+// --------------------------------------------------------------------
+// to write several buffers to the socket without first joining them
+// plain sockets hand them to the kernel as one vectored write, SSL packs
+// small buffers into records of up to SOCK_SSL_RECORD bytes and writes
+// large ones straight from where they are
+// --------------------------------------------------------------------
+
+bool TSocketClient::SockWriteChunks (const TSockChunk* pChunks, size_t pChunkCount, size_t& pBytesWritten, const void* pSet, bool pZeroCopy) {
+
+    ssize_t iStatus;
+    size_t  skip = 0;                           // bytes of pChunks[0] already written
+    bool    zerocopy = pZeroCopy and vZeroCopy;
+
+    // caller safe
+    pBytesWritten = 0;
+
+    // precaution -------- class level
+    if ( !(TSocketClient::g_flgLibReady == 1 and vSocket != 0)) {
+        SetErrMsg ( false, "Winsock/Class not initialized" );
+        return false;
+    }
+
+    // precaution --------- function level
+    if ( pChunks == NULL and pChunkCount > 0 ) {
+        SetErrMsg ( false, "SockWriteChunks, bad params" );
+        return false;
+    }
+
+    // with kernel TLS the buffers go down as plain ones, the kernel frames and encrypts the records
+    if (is_ssl and !vKtlsSend) {
+        char record[SOCK_SSL_RECORD];
+        size_t used = 0;
+        int written;
+
+        for (size_t i = 0; i <= pChunkCount; i++) {
+            const bool last = (i == pChunkCount);
+            const size_t size = last ? 0 : pChunks[i].pChunkSize;
+
+            // flush the packed record before it overflows or before a large buffer
+            if (used and (last or used + size > SOCK_SSL_RECORD)) {
+                if (!SockWriteChunk(record, used, written))
+                    return false;
+                pBytesWritten += used;
+                used = 0;
+            }
+            if (last or size == 0)
+                continue;
+            if (size >= SOCK_SSL_RECORD) {
+                if (!SockWriteChunk(pChunks[i].pBuffer, size, written))
+                    return false;
+                pBytesWritten += size;
+            }
+            else {
+                memcpy(record + used, pChunks[i].pBuffer, size);
+                used += size;
+            }
+        }
+        return true;
+    }
+
+    // send, resuming after partial writes
+    while (pChunkCount > 0) {
+        if (pChunks[0].pChunkSize == skip) {    // drop empty and finished buffers
+            pChunks++;
+            pChunkCount--;
+            skip = 0;
+            continue;
+        }
+        if (zerocopy)
+            iStatus = sock_sendv(pChunks, pChunkCount, skip, MSG_ZEROCOPY);
+        else
+            iStatus = vRing ? ring_sendv(pChunks, pChunkCount, skip, pSet) : sock_sendv(pChunks, pChunkCount, skip);
+        if ( iStatus == SOCKET_ERROR ) {
+            if (errno == EINTR)
+                continue;
+            if (zerocopy and errno == ENOBUFS) {        // out of optmem for the notifications, the rest goes out copied
+                zerocopy = false;
+                continue;
+            }
+            SetErrMsg ( true, "WSASend failed: %d\n ", errno);
+            return false;
+        }
+        if (zerocopy and iStatus > 0)
+            vZcNext++;                                  // every zero copy send that took bytes gets the next number
+        pBytesWritten += iStatus;
+
+        // advance past what went out
+        size_t sent = (size_t)iStatus;
+        while (pChunkCount > 0 and sent >= pChunks[0].pChunkSize - skip) {
+            sent -= pChunks[0].pChunkSize - skip;
+            pChunks++;
+            pChunkCount--;
+            skip = 0;
+        }
+        skip += sent;
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------------------
+// receives exactly buf_size bytes straight from the socket
+// --------------------------------------------------------------------
+
+bool TSocketClient::sock_recv_all (char *buf, size_t buf_size, const void* set) {
+
+    size_t  total_read = 0;
+    ssize_t bytes_read;
+
+    while (total_read < buf_size) {
+        if (vRing)
+            bytes_read = ring_recv (&buf[total_read], buf_size - total_read, MSG_WAITALL, set);
+        else
+            bytes_read = sock_recv (&buf[total_read], buf_size - total_read);
+        if ( bytes_read == SOCKET_ERROR ) {  // -1 bytes read means error
+            if (!is_ssl and errno == EINTR)
+                continue;
+            SetErrMsg (true, "WSARecv failed\n ");
+            return false;
+        }
+        if (bytes_read == 0)                // peer closed before the chunk was complete
+            return false;
+        total_read += bytes_read;
+    }
+    return true;
+}
+
+// --------------------------------------------------------------------
+// resizes the read-ahead buffer, bytes already buffered are kept
+// --------------------------------------------------------------------
+
+void TSocketClient::SockSetReadAhead (size_t pSize) {
+
+    size_t pending = vReadEnd - vReadPos;
+
+    if (pSize < pending)
+        pSize = pending;
+    std::unique_ptr<char[]> buf (pSize ? new char[pSize] : nullptr);
+    if (pending)
+        memcpy (buf.get(), &vReadBuf[vReadPos], pending);
+    vReadBuf.swap (buf);
+    vReadSize = pSize;
+    vReadPos  = 0;
+    vReadEnd  = pending;
+}
+
 // --------------------------------------------------------------------
 // to read a chunk from the socket
+// small chunks are served from the read-ahead buffer, which is refilled
+// with a single recv that often brings the following replies along;
+// chunks as large as the buffer are received straight into pBuffer
 // --------------------------------------------------------------------
 
-bool TSocketClient::SockReadChunk (char* pBuffer, int& pBytesRead, int pChunkSize) {
+bool TSocketClient::SockReadChunk (char* pBuffer, int& pBytesRead, int pChunkSize, const void* pSet) {
 
-    int  bytes_read;
-    int  total_read = 0;
+    size_t  total_read = 0;
+    size_t  chunk_size = pChunkSize;
+    ssize_t bytes_read;
     // caller safe
     pBytesRead = 0;
 
@@ -352,26 +719,40 @@ bool TSocketClient::SockReadChunk (char* pBuffer, int& pBytesRead, int pChunkSiz
         return false;
     }
 
-    // recv
-    while(true) {
-        bytes_read = (int)sock_recv (&pBuffer[total_read], pChunkSize - total_read);
+    while (total_read < chunk_size) {
+        // buffered bytes first
+        if (vReadPos < vReadEnd) {
+            size_t n = std::min (vReadEnd - vReadPos, chunk_size - total_read);
+            memcpy (&pBuffer[total_read], &vReadBuf[vReadPos], n);
+            vReadPos   += n;
+            total_read += n;
+            continue;
+        }
+        vReadPos = vReadEnd = 0;
+
+        // large remainder, no point going through the buffer
+        if (chunk_size - total_read >= vReadSize) {
+            if (!sock_recv_all (&pBuffer[total_read], chunk_size - total_read, pSet))
+                return false;
+            total_read = chunk_size;
+            break;
+        }
+
+        // refill
+        bytes_read = sock_recv (vReadBuf.get(), vReadSize);
         if ( bytes_read == SOCKET_ERROR ) {  // -1 bytes read means error
+            if (!is_ssl and errno == EINTR)
+                continue;
             SetErrMsg (true, "WSARecv failed\n ");
             return false;
         }
-        total_read = total_read + bytes_read;
-        if(total_read == pChunkSize)
-            break;
-        if(bytes_read == 0) {
-            if(total_read != pChunkSize)
-                return false; 
-            else 
-                break;
-        }
+        if (bytes_read == 0)                // peer closed before the chunk was complete
+            return false;
+        vReadEnd = bytes_read;
     }
 
     // bytes recd
-    pBytesRead = total_read;
+    pBytesRead = (int)total_read;
 
     return true;
 }
@@ -402,10 +783,611 @@ void TSocketClient::SockClose (void) {
             vSocket = INVALID_SOCKET;
         
         if (is_ssl) {
+            SSL_set_app_data(ssl, NULL);            // late session tickets must not reach a closed client
             SSL_shutdown(ssl);
             SSL_free(ssl);
         }
+        vKtlsSend = vNonBlocking = vZeroCopy = false;
+        vZcNext = vZcDone = 0;
+        vZcRanges.clear();
+        vReadPos = vReadEnd = 0;
+    }
+    ring_close();
+}
+
+
+// --------------------------------------------------------------------
+// selects how bytes move: SOCK_BACKEND_BLOCKING uses send/recv, while
+// SOCK_BACKEND_IO_URING submits them to an io_uring, several buffers per
+// system call and from registered buffers when SockRegisterBuffers knows
+// them; io_uring needs Linux, a kernel that allows it and a plain socket,
+// otherwise false is returned and the blocking backend stays in use
+// --------------------------------------------------------------------
+
+bool TSocketClient::SockSetBackend (int pBackend) {
+
+    if (pBackend == SOCK_BACKEND_BLOCKING) {
+        ring_close();
+        return true;
     }
+    if (pBackend != SOCK_BACKEND_IO_URING or vSocket == INVALID_SOCKET or is_ssl)
+        return false;
+#ifdef __linux__
+    if (vRing)
+        return true;
+
+    std::unique_ptr<TSockRing> ring (new TSockRing);
+    io_uring_params params;
+    memset (&params, 0, sizeof(params));
+    ring->fd = (int)syscall (__NR_io_uring_setup, SOCK_RING_ENTRIES, &params);
+    if (ring->fd < 0) {
+        SetErrMsg ( true, "io_uring_setup failed" );
+        return false;
+    }
+    ring->entries     = params.sq_entries;
+    ring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        ring->sq_map_size = ring->cq_map_size = std::max (ring->sq_map_size, ring->cq_map_size);
+    ring->sq_map = mmap (NULL, ring->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        ring->cq_map = ring->sq_map;
+    else if (ring->sq_map != MAP_FAILED)
+        ring->cq_map = mmap (NULL, ring->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    if (ring->cq_map != MAP_FAILED)
+        ring->sqes = (io_uring_sqe*)mmap (NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    vRing.swap (ring);
+    if (vRing->sqes == MAP_FAILED) {
+        ring_close();
+        SetErrMsg ( true, "io_uring mmap failed" );
+        return false;
+    }
+
+    char* sq = (char*)vRing->sq_map;
+    char* cq = (char*)vRing->cq_map;
+    vRing->sq_head  = (unsigned*)(sq + params.sq_off.head);
+    vRing->sq_tail  = (unsigned*)(sq + params.sq_off.tail);
+    vRing->sq_mask  = (unsigned*)(sq + params.sq_off.ring_mask);
+    vRing->sq_array = (unsigned*)(sq + params.sq_off.array);
+    vRing->cq_head  = (unsigned*)(cq + params.cq_off.head);
+    vRing->cq_tail  = (unsigned*)(cq + params.cq_off.tail);
+    vRing->cq_mask  = (unsigned*)(cq + params.cq_off.ring_mask);
+    vRing->cqes     = (io_uring_cqe*)(cq + params.cq_off.cqes);
+    return true;
+#else
+    return false;
+#endif
+}
+
+int TSocketClient::SockBackend (void) {
+
+    return vRing ? SOCK_BACKEND_IO_URING : SOCK_BACKEND_BLOCKING;
+}
+
+void TSocketClient::ring_close (void) {
+
+#ifdef __linux__
+    if (!vRing)
+        return;
+    if (vRing->sqes != MAP_FAILED)
+        munmap (vRing->sqes, vRing->sqes_size);
+    if (vRing->cq_map != MAP_FAILED and vRing->cq_map != vRing->sq_map)
+        munmap (vRing->cq_map, vRing->cq_map_size);
+    if (vRing->sq_map != MAP_FAILED)
+        munmap (vRing->sq_map, vRing->sq_map_size);
+    if (vRing->fd >= 0)
+        close (vRing->fd);                              // also drops the registered buffers
+#endif
+    vRing.reset();
+}
+
+// --------------------------------------------------------------------
+// registers the buffers of a set (e.g. one insert buffer of the ring, or
+// a fetch buffer) so transfers from and into them skip the per request
+// page pinning; pSet identifies the owner and is passed again to
+// SockWriteChunks / SockReadChunk; calling it again with the same
+// buffers costs nothing, changed buffers re-register every set
+// --------------------------------------------------------------------
+
+bool TSocketClient::SockRegisterBuffers (const void* pSet, const TSockChunk* pBuffers, size_t pCount) {
+
+#ifdef __linux__
+    if (!vRing or vRing->register_failed)
+        return false;
+
+    std::vector<iovec> iovs;
+    iovs.reserve (pCount);
+    for (size_t i = 0; i < pCount; i++)
+        if (pBuffers[i].pChunkSize)
+            iovs.push_back ({(void*)pBuffers[i].pBuffer, pBuffers[i].pChunkSize});
+
+    auto& sets = vRing->sets;
+    auto found = std::find_if (sets.begin(), sets.end(), [pSet] (const std::pair<const void*, std::vector<iovec>>& set) { return set.first == pSet; });
+    if (found != sets.end()) {
+        if (found->second.size() == iovs.size() and std::equal (iovs.begin(), iovs.end(), found->second.begin(),
+                [] (const iovec& a, const iovec& b) { return a.iov_base == b.iov_base and a.iov_len == b.iov_len; }))
+            return true;
+        sets.erase (found);
+    }
+    else if (sets.size() >= SOCK_REG_SETS)
+        sets.erase (sets.begin());
+    sets.emplace_back (pSet, std::move(iovs));
+
+    // the kernel takes the whole table at once
+    if (vRing->registered) {
+        syscall (__NR_io_uring_register, vRing->fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+        vRing->registered = false;
+    }
+    std::vector<iovec> table;
+    for (auto& set : sets)
+        table.insert (table.end(), set.second.begin(), set.second.end());
+    if (table.empty())
+        return true;
+    if (syscall (__NR_io_uring_register, vRing->fd, IORING_REGISTER_BUFFERS, table.data(), (unsigned)table.size()) < 0) {
+        vRing->register_failed = true;
+        sets.clear();
+        return false;
+    }
+    vRing->registered = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void TSocketClient::SockUnregisterBuffers (void) {
+
+#ifdef __linux__
+    if (!vRing)
+        return;
+    if (vRing->registered)
+        syscall (__NR_io_uring_register, vRing->fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+    vRing->registered = false;
+    vRing->sets.clear();
+#endif
+}
+
+#ifdef __linux__
+// --------------------------------------------------------------------
+// index of the registered buffer of a set holding [buf, buf+buf_size),
+// -1 when there is none
+// --------------------------------------------------------------------
+
+int TSocketClient::ring_fixed (const void* set, const void* buf, size_t buf_size) {
+
+    if (set == NULL or !vRing->registered)
+        return -1;
+    int index = 0;
+    for (auto& registered : vRing->sets) {
+        if (registered.first == set) {
+            for (const iovec& iov : registered.second) {
+                if ((const char*)buf >= (const char*)iov.iov_base and (const char*)buf + buf_size <= (const char*)iov.iov_base + iov.iov_len)
+                    return index;
+                index++;
+            }
+            return -1;
+        }
+        index += (int)registered.second.size();
+    }
+    return -1;
+}
+
+// --------------------------------------------------------------------
+// sends up to SOCK_RING_ENTRIES buffers as one chain of linked requests
+// in a single io_uring_enter; returns the bytes of the leading part that
+// went out, a short send breaks the chain and the caller resumes there
+// --------------------------------------------------------------------
+
+ssize_t TSocketClient::ring_sendv (const TSockChunk *chunks, size_t count, size_t skip, const void* set) {
+
+    TSockRing& ring = *vRing;
+    const unsigned n = (unsigned)std::min (count, (size_t)std::min (ring.entries, (unsigned)SOCK_RING_ENTRIES));
+    unsigned tail = *ring.sq_tail;
+
+    for (unsigned i = 0; i < n; i++) {
+        const unsigned idx = (tail + i) & *ring.sq_mask;
+        io_uring_sqe* sqe = &ring.sqes[idx];
+        const char* buf = (const char*)chunks[i].pBuffer + (i ? 0 : skip);
+        const size_t size = chunks[i].pChunkSize - (i ? 0 : skip);
+        const int fixed = ring_fixed (set, buf, size);
+
+        memset (sqe, 0, sizeof(*sqe));
+        sqe->fd   = (int)vSocket;
+        sqe->addr = (uint64_t)(uintptr_t)buf;
+        sqe->len  = (unsigned)std::min (size, (size_t)UINT32_MAX >> 1);
+        if (fixed >= 0) {
+            sqe->opcode    = IORING_OP_WRITE_FIXED;
+            sqe->buf_index = (uint16_t)fixed;
+        }
+        else {
+            sqe->opcode    = IORING_OP_SEND;
+            sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        }
+        sqe->flags     = (i + 1 < n) ? IOSQE_IO_LINK : 0;
+        sqe->user_data = i;
+        ring.sq_array[idx] = idx;
+    }
+    __atomic_store_n (ring.sq_tail, tail + n, __ATOMIC_RELEASE);
+
+    // results come back in any order, the chain tells how far it got
+    int results[SOCK_RING_ENTRIES] = {};
+    unsigned head = *ring.cq_head;
+    unsigned submit = n, done = 0;
+    while (done < n) {
+        if (submit or head == __atomic_load_n (ring.cq_tail, __ATOMIC_ACQUIRE)) {
+            const long entered = syscall (__NR_io_uring_enter, ring.fd, submit, n - done, IORING_ENTER_GETEVENTS, NULL, 0);
+            if (entered < 0 and errno != EINTR)
+                return SOCKET_ERROR;
+            if (entered > 0)
+                submit -= std::min (submit, (unsigned)entered);
+            continue;
+        }
+        const io_uring_cqe& cqe = ring.cqes[head & *ring.cq_mask];
+        results[cqe.user_data] = cqe.res;
+        head++;
+        done++;
+    }
+    __atomic_store_n (ring.cq_head, head, __ATOMIC_RELEASE);
+
+    ssize_t sent = 0;
+    for (unsigned i = 0; i < n; i++) {
+        const size_t size = chunks[i].pChunkSize - (i ? 0 : skip);
+        if (results[i] < 0) {
+            if (sent == 0 and results[i] != -ECANCELED) {
+                errno = -results[i];
+                return SOCKET_ERROR;
+            }
+            break;
+        }
+        sent += results[i];
+        if ((size_t)results[i] < size)
+            break;
+    }
+    return sent;
+}
+
+// --------------------------------------------------------------------
+// one receive through the ring, into a registered buffer when possible
+// --------------------------------------------------------------------
+
+ssize_t TSocketClient::ring_recv (char *buf, size_t buf_size, int flags, const void* set) {
+
+    TSockRing& ring = *vRing;
+    const unsigned tail = *ring.sq_tail;
+    const unsigned idx = tail & *ring.sq_mask;
+    io_uring_sqe* sqe = &ring.sqes[idx];
+    const int fixed = ring_fixed (set, buf, buf_size);
+
+    memset (sqe, 0, sizeof(*sqe));
+    sqe->fd   = (int)vSocket;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len  = (unsigned)std::min (buf_size, (size_t)UINT32_MAX >> 1);
+    if (fixed >= 0) {
+        sqe->opcode    = IORING_OP_READ_FIXED;
+        sqe->buf_index = (uint16_t)fixed;
+    }
+    else {
+        sqe->opcode    = IORING_OP_RECV;
+        sqe->msg_flags = flags;
+    }
+    ring.sq_array[idx] = idx;
+    __atomic_store_n (ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    unsigned head = *ring.cq_head;
+    unsigned submit = 1;
+    while (head == __atomic_load_n (ring.cq_tail, __ATOMIC_ACQUIRE)) {
+        if (syscall (__NR_io_uring_enter, ring.fd, submit, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0) {
+            if (errno != EINTR)
+                return SOCKET_ERROR;
+        }
+        else
+            submit = 0;
+    }
+    const int res = ring.cqes[head & *ring.cq_mask].res;
+    __atomic_store_n (ring.cq_head, head + 1, __ATOMIC_RELEASE);
+    if (res < 0) {
+        errno = -res;
+        return SOCKET_ERROR;
+    }
+    return res;
+}
+#else
+int     TSocketClient::ring_fixed (const void*, const void*, size_t) { return -1; }
+ssize_t TSocketClient::ring_sendv (const TSockChunk*, size_t, size_t, const void*) { return SOCKET_ERROR; }
+ssize_t TSocketClient::ring_recv  (char*, size_t, int, const void*) { return SOCKET_ERROR; }
+#endif
+
+// --------------------------------------------------------------------
+// MSG_ZEROCOPY: the kernel sends straight from the caller's pages and
+// tells on the error queue when it let go of them, a buffer handed to
+// SockWriteChunks with pZeroCopy must stay untouched until then; plain
+// sockets on Linux only, cleared by SockClose
+// --------------------------------------------------------------------
+
+bool TSocketClient::SockEnableZeroCopy (bool pEnable) {
+
+    if (!pEnable) {
+        vZeroCopy = false;
+        return true;
+    }
+#ifdef __linux__
+    int one = 1;
+    if (vSocket == INVALID_SOCKET or is_ssl)
+        return false;
+    if (!vZeroCopy and setsockopt (vSocket, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) != 0) {
+        SetErrMsg ( true, "setsockopt SO_ZEROCOPY failed" );
+        return false;
+    }
+    vZeroCopy = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool TSocketClient::SockZeroCopyActive (void) {
+
+    return vZeroCopy;
+}
+
+uint32_t TSocketClient::SockZeroCopySent (void) {
+
+    return vZcNext;
+}
+
+bool TSocketClient::SockZeroCopyWait (uint32_t pMark) {
+
+#ifdef __linux__
+    while ((int32_t)(pMark - vZcDone) > 0) {
+        if (!zc_reap())
+            return false;
+        if ((int32_t)(pMark - vZcDone) <= 0)
+            break;
+
+        // a pending notification raises POLLERR
+        pollfd pfd = {(int)vSocket, 0, 0};
+        const int ready = poll (&pfd, 1, SOCK_ZEROCOPY_WAIT);
+        if (ready == 0) {
+            SetErrMsg ( false, "zero copy completion timed out" );
+            return false;
+        }
+        if (ready < 0 and errno != EINTR) {
+            SetErrMsg ( true, "poll failed" );
+            return false;
+        }
+        if ((pfd.revents & (POLLHUP | POLLNVAL)) and !(pfd.revents & POLLERR)) {
+            SetErrMsg ( false, "connection closed with zero copy sends pending" );
+            return false;
+        }
+    }
+#else
+    (void)pMark;
+#endif
+    return true;
+}
+
+#ifdef __linux__
+// --------------------------------------------------------------------
+// takes every completion off the error queue; a range the kernel had to
+// copy anyway (e.g. loopback) turns zero copy off, the deferred
+// notification would only add to the cost of a plain send
+// --------------------------------------------------------------------
+
+bool TSocketClient::zc_reap (void) {
+
+    char control[128];
+    msghdr msg;
+
+    for (;;) {
+        memset (&msg, 0, sizeof(msg));
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg (vSocket, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno == EAGAIN or errno == EWOULDBLOCK)
+                return true;
+            if (errno == EINTR)
+                continue;
+            SetErrMsg ( true, "reading zero copy completions failed" );
+            return false;
+        }
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!((cmsg->cmsg_level == SOL_IP and cmsg->cmsg_type == IP_RECVERR) or (cmsg->cmsg_level == SOL_IPV6 and cmsg->cmsg_type == IPV6_RECVERR)))
+                continue;
+            const sock_extended_err* err = (const sock_extended_err*)CMSG_DATA(cmsg);
+            if (err->ee_origin != SO_EE_ORIGIN_ZEROCOPY or err->ee_errno != 0)
+                continue;
+            if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                vZeroCopy = false;
+
+            // the kernel reports [ee_info, ee_data], mostly in order
+            vZcRanges.emplace_back (err->ee_info, err->ee_data + 1);
+            for (bool merged = true; merged; ) {
+                merged = false;
+                for (size_t i = 0; i < vZcRanges.size(); i++) {
+                    if ((int32_t)(vZcRanges[i].first - vZcDone) <= 0) {
+                        if ((int32_t)(vZcRanges[i].second - vZcDone) > 0)
+                            vZcDone = vZcRanges[i].second;
+                        vZcRanges.erase (vZcRanges.begin() + i);
+                        merged = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+#endif
+
+// --------------------------------------------------------------------
+// switches the socket between blocking and non-blocking io; non-blocking
+// sockets are driven with SockSendSome / SockRecvSome and SockHandle
+// --------------------------------------------------------------------
+
+bool TSocketClient::SockSetNonBlocking (bool pNonBlocking) {
+
+#ifdef __linux__
+    int flags = fcntl (vSocket, F_GETFL, 0);
+    if (flags == -1 or fcntl (vSocket, F_SETFL, pNonBlocking ? flags | O_NONBLOCK : flags & ~O_NONBLOCK) == -1) {
+        SetErrMsg ( true, "fcntl failed" );
+        return false;
+    }
+    if (is_ssl) {
+        // a retried SSL_write may come with the rest of the data only, and may be told part of it went
+        if (pNonBlocking)
+            SSL_set_mode (ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+        else
+            SSL_clear_mode (ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    }
+    vNonBlocking = pNonBlocking;
+    return true;
+#else
+    u_long mode = pNonBlocking ? 1 : 0;
+    return ioctlsocket (vSocket, FIONBIO, &mode) == 0;
+#endif
+}
+
+int TSocketClient::SockHandle (void) {
+
+    return (int)vSocket;
+}
+
+// --------------------------------------------------------------------
+// maps the result of a send/recv or SSL_write/SSL_read that moved no
+// bytes to one of the SOCK_IO_* codes
+// --------------------------------------------------------------------
+
+int TSocketClient::sock_io_status (ssize_t result, bool through_ssl) {
+
+    if (through_ssl) {
+        switch (SSL_get_error (ssl, (int)result)) {
+            case SSL_ERROR_WANT_READ:
+            case SSL_ERROR_WANT_WRITE:  return SOCK_IO_WOULD_BLOCK;
+            case SSL_ERROR_ZERO_RETURN: return SOCK_IO_CLOSED;
+            default:                    return SOCK_IO_ERROR;
+        }
+    }
+    if (result == 0)
+        return SOCK_IO_CLOSED;
+    if (errno == EAGAIN or errno == EWOULDBLOCK or errno == EINTR)
+        return SOCK_IO_WOULD_BLOCK;
+    return SOCK_IO_ERROR;
+}
+
+// --------------------------------------------------------------------
+// writes as much of the buffer as the socket takes without blocking
+// --------------------------------------------------------------------
+
+int TSocketClient::SockSendSome (const void* pBuffer, size_t pSize, size_t& pBytesWritten) {
+
+    ssize_t iStatus;
+
+    pBytesWritten = 0;
+    if (pSize == 0)
+        return SOCK_IO_DONE;
+    if (is_ssl and !vKtlsSend)
+        iStatus = SSL_write (ssl, pBuffer, (int)std::min (pSize, (size_t)INT32_MAX));
+    else {
+#ifdef __linux__
+        iStatus = send (vSocket, pBuffer, pSize, MSG_NOSIGNAL);
+#else
+        iStatus = send (vSocket, (const char*)pBuffer, (int)pSize, 0);
+#endif
+    }
+    if (iStatus > 0) {
+        pBytesWritten = iStatus;
+        return SOCK_IO_DONE;
+    }
+    return sock_io_status (iStatus, is_ssl and !vKtlsSend);
+}
+
+// --------------------------------------------------------------------
+// reads what is available without blocking, buffered bytes first; like
+// SockReadChunk small reads refill the read-ahead buffer
+// --------------------------------------------------------------------
+
+int TSocketClient::SockRecvSome (char* pBuffer, size_t pSize, size_t& pBytesRead) {
+
+    ssize_t iStatus;
+
+    pBytesRead = 0;
+    if (pSize == 0)
+        return SOCK_IO_DONE;
+    if (vReadPos == vReadEnd) {
+        vReadPos = vReadEnd = 0;
+        if (pSize >= vReadSize) {
+            iStatus = sock_recv (pBuffer, std::min (pSize, (size_t)INT32_MAX));
+            if (iStatus > 0) {
+                pBytesRead = iStatus;
+                return SOCK_IO_DONE;
+            }
+            return sock_io_status (iStatus, is_ssl);
+        }
+        iStatus = sock_recv (vReadBuf.get(), vReadSize);
+        if (iStatus <= 0)
+            return sock_io_status (iStatus, is_ssl);
+        vReadEnd = iStatus;
+    }
+    pBytesRead = std::min (vReadEnd - vReadPos, pSize);
+    memcpy (pBuffer, &vReadBuf[vReadPos], pBytesRead);
+    vReadPos += pBytesRead;
+
+    return SOCK_IO_DONE;
+}
+
+
+// --------------------------------------------------------------------
+// tells whether the TLS handshake resumed an earlier session
+// --------------------------------------------------------------------
+
+bool TSocketClient::SockSessionReused (void) {
+
+    return is_ssl and vSocket != INVALID_SOCKET and SSL_session_reused(ssl);
+}
+
+
+// --------------------------------------------------------------------
+// asks OpenSSL to hand the record layer to the kernel (kTLS) once the
+// handshake of the next SockCreateAndConnect is done; when the tls module,
+// the cipher or the OpenSSL build can't do it everything stays in user space
+// --------------------------------------------------------------------
+
+void TSocketClient::SockEnableKtls (bool pEnable) {
+
+    vKtls = pEnable;
+}
+
+bool TSocketClient::SockKtlsActive (void) {
+
+    return vKtlsSend and vSocket != INVALID_SOCKET;
+}
+
+
+// --------------------------------------------------------------------
+// checks, without blocking, that an idle socket is still usable
+// the peer closing it or unexpected bytes waiting on a plain socket
+// make it unusable, TLS may legitimately have post-handshake records
+// --------------------------------------------------------------------
+
+bool TSocketClient::SockIsAlive (void) {
+
+    if (vSocket == INVALID_SOCKET)
+        return false;
+    if (vReadPos < vReadEnd)                            // an idle connection has nothing left to read
+        return false;
+
+#ifdef __linux__
+    char    c;
+    ssize_t iStatus = recv(vSocket, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+
+    if (iStatus == 0)                                   // orderly shutdown by the peer
+        return false;
+    if (iStatus == SOCKET_ERROR)
+        return errno == EAGAIN or errno == EWOULDBLOCK;
+    return is_ssl;
+#else
+    return true;
+#endif
 }
 
 
@@ -1169,6 +1169,505 @@ SUBCASE("simple_bulk") {
     sqc.finish_query();
 }
 
+SUBCASE("simple_bulk_prefetch") {
+    run_direct_query(&sqc, "create or replace table t (x int not null)");
+    new_query_execute(&sqc, "insert into t values (?)");
+    int nrows = 1024 * 1024;
+
+    unsigned int seed = rand();
+    srand(seed);
+    for (int i = 0; i < nrows; ++i) {
+        sqc.set_int(0, rand());
+        sqc.next_query_row();
+    }
+    sqc.finish_query();
+
+    sqc.set_prefetch_depth(2);
+    new_query_execute(&sqc, "select * from t");
+    int row_count = 0;
+    srand(seed);
+    while (sqc.next_query_row()) {
+        CHECK(sqc.get_int(0) == rand());
+        ++row_count;
+    }
+    CHECK(row_count == nrows);
+    sqc.finish_query();
+
+    new_query_execute(&sqc, "select * from t");
+    CHECK(sqc.next_query_row());
+    sqc.finish_query();
+    sqc.set_prefetch_depth(0);
+
+    sqc.set_fetch_pipeline(4);
+    new_query_execute(&sqc, "select * from t");
+    row_count = 0;
+    srand(seed);
+    while (sqc.next_query_row()) {
+        CHECK(sqc.get_int(0) == rand());
+        ++row_count;
+    }
+    CHECK(row_count == nrows);
+    sqc.finish_query();
+    sqc.set_fetch_pipeline(1);
+}
+
+SUBCASE("simple_bulk_buffer_ring") {
+    run_direct_query(&sqc, "create or replace table t (x int not null)");
+    sqc.set_insert_buffers(4, 1 << 20);
+    new_query_execute(&sqc, "insert into t values (?)");
+    int nrows = 1024 * 1024;
+
+    for (int i = 0; i < nrows; ++i) {
+        sqc.set_int(0, i);
+        sqc.next_query_row(1 << 16);
+    }
+    sqc.finish_query();
+    sqc.set_insert_buffers(sqream::CONSTS::BUFF_COUNT);
+
+    new_query_execute(&sqc, "select * from t");
+    int row_count = 0;
+    while (sqc.next_query_row()) {
+        CHECK(sqc.get_int(0) == row_count);
+        ++row_count;
+    }
+    CHECK(row_count == nrows);
+    sqc.finish_query();
+
+    CHECK_THROWS_AS(sqc.set_insert_buffers(1), std::string);
+}
+
+SUBCASE("parallel_loader_bulk") {
+    run_direct_query(&sqc, "create or replace table t (x int not null)");
+    sqream::parallel_loader loader(4);
+    loader.connect(sqc.sqc_->ipv4_, sqc.sqc_->port_, sqc.sqc_->ssl_, sqc.sqc_->username_, sqc.sqc_->password_, sqc.sqc_->database_, sqc.sqc_->service_);
+    loader.begin("insert into t values (?)");
+    int nbatches = 64, batch_rows = 16 * 1024;
+    loader.load(nbatches, [batch_rows](sqream::driver &drv, size_t batch) {
+        for (int i = 0; i < batch_rows; ++i) {
+            drv.set_int(0, batch * batch_rows + i);
+            drv.next_query_row();
+        }
+        return size_t(batch_rows);
+    });
+    loader.finish();
+    CHECK(loader.rows() == uint64_t(nbatches * batch_rows));
+    CHECK(loader.bytes() == loader.rows() * sizeof(int32_t));
+
+    new_query_execute(&sqc, "select * from t");
+    std::vector<bool> seen(nbatches * batch_rows, false);
+    int row_count = 0;
+    while (sqc.next_query_row()) {
+        CHECK(!seen[sqc.get_int(0)]);
+        seen[sqc.get_int(0)] = true;
+        ++row_count;
+    }
+    CHECK(row_count == nbatches * batch_rows);
+    sqc.finish_query();
+
+    loader.begin("insert into t values (?)");
+    CHECK_THROWS_AS(loader.load(8, [](sqream::driver &drv, size_t batch) -> size_t {
+        if (batch == 5) throw std::string("batch failed");
+        drv.set_int(0, 0);
+        drv.next_query_row();
+        return 1;
+    }), std::string);
+    CHECK_THROWS_AS(loader.finish(), std::string);
+}
+
+SUBCASE("connection_pool_checkout") {
+    sqream::connection_pool pool(sqc.sqc_->ipv4_, sqc.sqc_->port_, sqc.sqc_->ssl_, sqc.sqc_->username_, sqc.sqc_->password_, sqc.sqc_->database_, sqc.sqc_->service_, 1, 2, std::chrono::milliseconds(0));
+    CHECK(pool.size() == 1);
+    sqream::driver first, second, third;
+    pool.checkout(first);
+    pool.checkout(second);
+    CHECK(pool.size() == 2);
+    CHECK_THROWS_AS(pool.checkout(third, std::chrono::milliseconds(10)), std::string);
+
+    new_query_execute(&first, "select 1");
+    CHECK(first.next_query_row());
+    CHECK(first.get_int(0) == 1);
+    pool.checkin(first);
+    pool.checkout(third);
+    new_query_execute(&third, "select 1");
+    CHECK(third.next_query_row());
+    third.finish_query();
+    pool.checkin(third);
+    pool.checkin(second);
+
+    pool.evict_idle();
+    CHECK(pool.size() == 1);
+    CHECK(pool.idle() == 1);
+
+    for (int i = 0; i < 3; ++i) {
+        sqream::driver scoped;
+        pool.checkout(scoped, std::chrono::milliseconds(10));
+        new_query_execute(&scoped, "select 1");
+    }
+    CHECK(pool.size() == 1);
+    CHECK(pool.idle() == 1);
+}
+
+SUBCASE("statement_cache_reuse") {
+    sqc.set_statement_cache(8);
+    run_direct_query(&sqc, "create or replace table t (x int not null, y nvarchar(10) null)");
+    for (int i = 0; i < 10; ++i) {
+        new_query_execute(&sqc, "insert into t values (?,?)");
+        sqc.set_int(0, i);
+        sqc.set_nvarchar(1, std::to_string(i));
+        sqc.next_query_row();
+        sqc.finish_query();
+    }
+    for (int pass = 0; pass < 2; ++pass) {
+        new_query_execute(&sqc, "select * from t");
+        CHECK(sqream::get_metadata(&sqc).size() == 2);
+        int row_count = 0;
+        while (sqc.next_query_row()) {
+            CHECK(sqc.get_nvarchar(1) == std::to_string(sqc.get_int(0)));
+            ++row_count;
+        }
+        CHECK(row_count == 10);
+        sqc.finish_query();
+    }
+
+    sqream::driver other;
+    other.connect(sqc.sqc_->ipv4_, sqc.sqc_->port_, sqc.sqc_->ssl_, sqc.sqc_->username_, sqc.sqc_->password_, sqc.sqc_->database_, sqc.sqc_->service_);
+    run_direct_query(&other, "create or replace table t (x int not null, y nvarchar(10) null, z int null)");
+    new_query_execute(&other, "insert into t values (?,?,?)");
+    other.set_int(0, 7);
+    other.set_nvarchar(1, "7");
+    other.set_int(2, 70);
+    other.next_query_row();
+    other.finish_query();
+    new_query_execute(&sqc, "select * from t");
+    REQUIRE(sqc.next_query_row());
+    CHECK(sqream::get_metadata(&sqc).size() == 3);
+    CHECK(sqc.get_int(2) == 70);
+    CHECK_FALSE(sqc.next_query_row());
+    sqc.finish_query();
+
+    /// Same blocks, wider first column: only the block sizes tell the cached metadata apart
+    run_direct_query(&other, "create or replace table t (x bigint not null, y nvarchar(10) null, z int null)");
+    new_query_execute(&other, "insert into t values (?,?,?)");
+    other.set_long(0, 8);
+    other.set_nvarchar(1, "8");
+    other.set_int(2, 80);
+    other.next_query_row();
+    other.finish_query();
+    new_query_execute(&sqc, "select * from t");
+    {
+        sqream::typed_cursor<int64_t, std::optional<std::string_view>, std::optional<int32_t>> rows(sqc);
+        REQUIRE(rows.next());
+        CHECK(rows.get<0>() == 8);
+        CHECK(rows.get<2>() == 80);
+    }
+    sqc.finish_query();
+
+    run_direct_query(&sqc, "create or replace table t (x int not null)");
+    new_query_execute(&sqc, "select * from t");
+    CHECK(sqream::get_metadata(&sqc).size() == 1);
+    sqc.finish_query();
+    sqc.set_statement_cache(0);
+}
+
+SUBCASE("read_ahead_sizes") {
+    run_direct_query(&sqc, "create or replace table t (x int not null, y nvarchar(10) null)");
+    new_query_execute(&sqc, "insert into t values (?,?)");
+    for (int i = 0; i < 1000; ++i) {
+        sqc.set_int(0, i);
+        sqc.set_nvarchar(1, std::to_string(i));
+        sqc.next_query_row();
+    }
+    sqc.finish_query();
+    for (size_t read_ahead : {size_t(0), size_t(13), size_t(1 << 20), size_t(sqream::CONSTS::READ_AHEAD)}) {
+        sqc.set_read_ahead(read_ahead);
+        new_query_execute(&sqc, "select * from t");
+        int row_count = 0;
+        while (sqc.next_query_row()) {
+            CHECK(sqc.get_nvarchar(1) == std::to_string(sqc.get_int(0)));
+            ++row_count;
+        }
+        CHECK(row_count == 1000);
+        sqc.finish_query();
+    }
+}
+
+SUBCASE("reactor_insert_select") {
+    run_direct_query(&sqc, "create or replace table t (x int not null)");
+    sqream::reactor events(2);
+    sqream::connector conn;
+    conn.connect(sqc.sqc_->ipv4_, sqc.sqc_->port_, sqc.sqc_->ssl_, sqc.sqc_->username_, sqc.sqc_->password_, sqc.sqc_->database_, sqc.sqc_->service_);
+    conn.open_prepare_statement("insert into t values (?)", 0);
+    events.attach(conn);
+    std::promise<std::string> inserted;
+    events.execute(conn, [&](const std::string &error, sqream::CONSTS::statement_type type, std::vector<sqream::column> &metadata_in, std::vector<sqream::column> &) {
+        CHECK(error.empty());
+        CHECK(type == sqream::CONSTS::insert);
+        CHECK(metadata_in.size() == 1);
+        std::vector<char> rows(1000 * sizeof(int32_t));
+        for (int32_t i = 0; i < 1000; ++i) memcpy(&rows[i * sizeof(int32_t)], &i, sizeof(int32_t));
+        events.put(conn, std::move(rows), 1000, [&](const std::string &error) { inserted.set_value(error); });
+    });
+    CHECK(inserted.get_future().get().empty());
+    events.detach(conn);
+    conn.close_statement();
+
+    conn.open_prepare_statement("select * from t", 0);
+    events.attach(conn);
+    std::promise<size_t> selected;
+    size_t row_count = 0;
+    std::function<void(const std::string &, size_t, sqream::raw_buffer &, std::vector<uint64_t> &)> fetched = [&](const std::string &error, size_t rows, sqream::raw_buffer &, std::vector<uint64_t> &) {
+        row_count += rows;
+        if (rows and error.empty()) events.fetch(conn, fetched);
+        else selected.set_value(row_count);
+    };
+    events.execute(conn, [&](const std::string &error, sqream::CONSTS::statement_type type, std::vector<sqream::column> &, std::vector<sqream::column> &) {
+        CHECK(error.empty());
+        CHECK(type == sqream::CONSTS::select);
+        events.fetch(conn, fetched);
+    });
+    CHECK(selected.get_future().get() == 1000);
+    events.detach(conn);
+    conn.close_statement();
+
+    conn.open_prepare_statement("select * from t", 0);
+    events.attach(conn);
+    std::promise<std::string> failed;
+    events.execute(conn, [](const std::string &, sqream::CONSTS::statement_type, std::vector<sqream::column> &, std::vector<sqream::column> &) { throw 42; });
+    events.fetch(conn, [&](const std::string &error, size_t, sqream::raw_buffer &, std::vector<uint64_t> &) { failed.set_value(error); });
+    CHECK_FALSE(failed.get_future().get().empty());
+    events.detach(conn);
+}
+
+SUBCASE("io_uring_backend") {
+    run_direct_query(&sqc, "create or replace table t (x int not null, y nvarchar(10) null)");
+    sqc.set_io_backend(sqream::CONSTS::uring);
+    if (sqc.sqc_->ssl_)
+        CHECK(sqc.sqc_->io_backend() == sqream::CONSTS::blocking);
+    new_query_execute(&sqc, "insert into t values (?,?)");
+    for (int i = 0; i < 100000; ++i) {
+        sqc.set_int(0, i);
+        if (i % 3) sqc.set_nvarchar(1, std::to_string(i)); else sqc.set_null(1);
+        sqc.next_query_row(1 << 20);
+    }
+    sqc.finish_query();
+    new_query_execute(&sqc, "select * from t");
+    int row_count = 0;
+    while (sqc.next_query_row()) {
+        const int x = sqc.get_int(0);
+        if (x % 3) CHECK(sqc.get_nvarchar(1) == std::to_string(x));
+        else CHECK(sqc.is_null(1));
+        ++row_count;
+    }
+    CHECK(row_count == 100000);
+    sqc.finish_query();
+    sqc.set_io_backend(sqream::CONSTS::blocking);
+}
+
+SUBCASE("zerocopy_puts") {
+    run_direct_query(&sqc, "create or replace table t (x int not null, y nvarchar(10) null)");
+    sqc.set_zerocopy(true);
+    if (sqc.sqc_->ssl_)
+        CHECK_FALSE(sqc.sqc_->zerocopy_active());
+    new_query_execute(&sqc, "insert into t values (?,?)");
+    for (int i = 0; i < 300000; ++i) {
+        sqc.set_int(0, i);
+        if (i % 4) sqc.set_nvarchar(1, std::to_string(i)); else sqc.set_null(1);
+        sqc.next_query_row(1 << 20);
+    }
+    sqc.finish_query();
+    new_query_execute(&sqc, "select * from t");
+    int row_count = 0;
+    while (sqc.next_query_row()) {
+        const int x = sqc.get_int(0);
+        if (x % 4) CHECK(sqc.get_nvarchar(1) == std::to_string(x));
+        else CHECK(sqc.is_null(1));
+        ++row_count;
+    }
+    CHECK(row_count == 300000);
+    sqc.finish_query();
+    sqc.set_zerocopy(false);
+}
+
+SUBCASE("typed_cursor") {
+    run_direct_query(&sqc, "create or replace table t (x int not null, y double null, z nvarchar(10) null)");
+    new_query_execute(&sqc, "insert into t values (?,?,?)");
+    for (int i = 0; i < 1000; ++i) {
+        sqc.set_int(0, i);
+        if (i % 3) sqc.set_double(1, i / 2.0); else sqc.set_null(1);
+        sqc.set_nvarchar(2, std::to_string(i));
+        sqc.next_query_row();
+    }
+    sqc.finish_query();
+    new_query_execute(&sqc, "select * from t");
+    CHECK_THROWS((sqream::typed_cursor<int32_t, double, std::optional<std::string_view>>(sqc)));
+    CHECK_THROWS((sqream::typed_cursor<int64_t, std::optional<double>, std::optional<std::string_view>>(sqc)));
+    sqream::typed_cursor<int32_t, std::optional<double>, std::optional<std::string_view>> rows(sqc);
+    int row_count = 0;
+    while (rows.next()) {
+        auto [x, y, z] = rows.row();
+        CHECK(rows.get<0>() == x);
+        if (x % 3) CHECK(y == x / 2.0);
+        else CHECK_FALSE(y.has_value());
+        CHECK(z == std::to_string(x));
+        ++row_count;
+    }
+    CHECK(row_count == 1000);
+    sqc.finish_query();
+}
+
+SUBCASE("typed_appender") {
+    run_direct_query(&sqc, "create or replace table t (x int not null, y double null, z nvarchar(10) null, w varchar(4) not null)");
+    new_query_execute(&sqc, "insert into t values (?,?,?,?)");
+    CHECK_THROWS((sqream::typed_appender<int32_t, double, std::optional<std::string_view>, std::string_view>(sqc)));
+    CHECK_THROWS((sqream::typed_appender<int32_t, std::optional<double>, std::optional<std::string_view>, std::optional<std::string_view>>(sqc)));
+    sqream::typed_appender<int32_t, std::optional<double>, std::optional<std::string_view>, std::string_view> rows(sqc);
+    CHECK_THROWS(rows.append({0, 0.0, std::nullopt, "12345"}));
+    for (int i = 0; i < 1000; ++i) {
+        const std::string z = std::to_string(i);
+        if (i == 500) {
+            // rows set by the driver setters go into the same buffer, once complete
+            sqc.set_int(0, i);
+            CHECK_THROWS(rows.append({i, std::nullopt, std::nullopt, z}));
+            sqc.set_double(1, i / 2.0);
+            sqc.set_null(2);
+            sqc.set_varchar(3, z);
+            sqc.next_query_row();
+            continue;
+        }
+        rows.append({i, (i % 3) ? std::optional<double>(i / 2.0) : std::nullopt, (i % 5) ? std::optional<std::string_view>(z) : std::nullopt, z});
+    }
+    sqc.finish_query();
+    CHECK_THROWS(rows.append({0, 0.0, std::nullopt, "0"}));
+    new_query_execute(&sqc, "select * from t");
+    sqream::typed_cursor<int32_t, std::optional<double>, std::optional<std::string_view>, std::string_view> cursor(sqc);
+    int row_count = 0;
+    while (cursor.next()) {
+        auto [x, y, z, w] = cursor.row();
+        if (x % 3) CHECK(y == x / 2.0);
+        else CHECK_FALSE(y.has_value());
+        if (x % 5) CHECK(z == std::to_string(x));
+        else CHECK_FALSE(z.has_value());
+        std::string padded = std::to_string(x);
+        padded.resize(4, ' ');
+        CHECK(w == padded);
+        ++row_count;
+    }
+    CHECK(row_count == 1000);
+    sqc.finish_query();
+}
+
+SUBCASE("column_type_codes") {
+    run_direct_query(&sqc, "create or replace table t (x int not null, y double null, z nvarchar(10) null, w varchar(4) null)");
+    new_query_execute(&sqc, "insert into t values (?,?,?,?)");
+    CHECK_THROWS_AS(sqc.get_column_index(""), std::string);
+    CHECK_THROWS_AS(sqc.set_int("", 0), std::string);
+    std::vector<sqream::column> in = sqream::get_metadata(&sqc);
+    REQUIRE(in.size() == 4);
+    CHECK(in[0].type_code == sqream::CONSTS::ftInt);
+    CHECK((in[0].null_block == sqream::CONSTS::NO_BLOCK && in[0].data_block == 0 && in[0].blocks == 1));
+    CHECK(in[1].type_code == sqream::CONSTS::ftDouble);
+    CHECK((in[1].null_block == 0 && in[1].data_block == 1 && in[1].blocks == 2));
+    CHECK(in[2].type_code == sqream::CONSTS::ftBlob);
+    CHECK((in[2].null_block == 0 && in[2].length_block == 1 && in[2].data_block == 2 && in[2].blocks == 3));
+    CHECK(in[3].type_code == sqream::CONSTS::ftVarchar);
+    for (int i = 0; i < 10; ++i) {
+        sqc.set_int(0, i);
+        if (i % 2) sqc.set_double(1, i);
+        else sqc.set_null(1);
+        if (i % 2) sqc.set_nvarchar(2, "n" + std::to_string(i));
+        else sqc.set_null(2);
+        if (i % 2) sqc.set_varchar(3, "v");
+        else sqc.set_null(3);
+        sqc.next_query_row();
+    }
+    sqc.finish_query();
+    new_query_execute(&sqc, "select * from t");
+    CHECK(sqream::get_metadata(&sqc)[2].type_code == sqream::CONSTS::ftBlob);
+    int row_count = 0;
+    while (sqc.next_query_row()) {
+        const int x = sqc.get_int(0);
+        CHECK(sqc.is_null(1) == !(x % 2));
+        CHECK(sqc.is_null(2) == !(x % 2));
+        CHECK(sqc.is_null(3) == !(x % 2));
+        if (x % 2) {
+            CHECK(sqc.get_double(1) == x);
+            CHECK(sqc.get_nvarchar(2) == "n" + std::to_string(x));
+        }
+        ++row_count;
+    }
+    CHECK(row_count == 10);
+    sqc.finish_query();
+}
+
+SUBCASE("string_views") {
+    run_direct_query(&sqc, "create or replace table t (x int not null, v varchar(8) not null, n nvarchar(20) not null)");
+    new_query_execute(&sqc, "insert into t values (?,?,?)");
+    for (int i = 0; i < 3000; ++i) {
+        sqc.set_int(0, i);
+        sqc.set_varchar(1, std::to_string(i));
+        sqc.set_nvarchar(2, "n" + std::to_string(i));
+        sqc.next_query_row();
+    }
+    sqc.finish_query();
+    new_query_execute(&sqc, "select * from t");
+    int row_count = 0;
+    while (sqc.next_query_row()) {
+        const std::string x = std::to_string(sqc.get_int(0));
+        CHECK(sqc.get_varchar_view(1, true) == x);
+        CHECK(sqc.get_varchar_view(1).size() == 8);
+        CHECK(sqc.get_varchar_view(1) == sqc.get_varchar(1));
+        CHECK(sqc.get_nvarchar_view(2) == "n" + x);
+        ++row_count;
+    }
+    CHECK(row_count == 3000);
+    CHECK_THROWS_AS(sqc.get_nvarchar_view(1), std::string);
+    sqc.finish_query();
+}
+
+SUBCASE("column_chunk_bulk") {
+    run_direct_query(&sqc, "create or replace table t (x int not null, y double null)");
+    new_query_execute(&sqc, "insert into t values (?,?)");
+    int nrows = 100000;
+    int batch = 1000;
+
+    std::vector<int32_t> xs(batch);
+    std::vector<double> ys(batch);
+    std::unique_ptr<bool[]> nulls(new bool[batch]);
+    for (int i = 0; i < nrows; i += batch) {
+        for (int j = 0; j < batch; ++j) {
+            xs[j] = i + j;
+            ys[j] = (i + j) / 2.0;
+            nulls[j] = (i + j) % 3 == 0;
+        }
+        REQUIRE_THROWS_AS(sqc.next_query_rows(), std::string);
+        sqc.set_int_column(0, xs);
+        REQUIRE_THROWS_AS(sqc.set_int_column(0, xs), std::string);
+        REQUIRE_THROWS_AS(sqc.set_double_column(1, std::span<const double>(ys).first(batch - 1)), std::string);
+        sqc.set_double_column(1, ys, std::span<const bool>(nulls.get(), batch));
+        sqc.next_query_rows();
+    }
+    sqc.finish_query();
+
+    new_query_execute(&sqc, "select * from t");
+    REQUIRE_THROWS_AS(sqc.get_int_column(0), std::string);
+    int row_count = 0;
+    while (sqc.next_query_chunk()) {
+        auto xs = sqc.get_int_column(0);
+        auto ys = sqc.get_double_column(1);
+        auto nulls = sqc.get_null_column(1);
+        REQUIRE(xs.size() == sqc.get_chunk_rows());
+        REQUIRE_THROWS_AS(sqc.get_long_column(0), std::string);
+        REQUIRE_THROWS_AS(sqc.get_null_column(0), std::string);
+        for (size_t r = 0; r < xs.size(); ++r, ++row_count) {
+            CHECK(xs[r] == row_count);
+            CHECK(nulls[r] == (row_count % 3 == 0));
+            if (!nulls[r]) CHECK(ys[r] == row_count / 2.0);
+        }
+    }
+    CHECK(row_count == nrows);
+    sqc.finish_query();
+}
+
 
 SUBCASE("all_types") {
     run_direct_query(&sqc,"create or replace table t (bool0 bool not null,bit1 bit not null,tinyint2 tinyint not null,smallint3 smallint not null,int4 int not null,bigint5 bigint not null,real6 real not null,float7 float not null,date8 date not null,datetime9 datetime not null,varchar_10_10 varchar(10) not null,varchar_100_11 varchar(100) not null, nvarchar_20_12 nvarchar(20) not null)");
@@ -1309,58 +1808,43 @@ SUBCASE("all_types_with_nulls") {
 SUBCASE("all_types_with_nulls_named_col") {
 
     run_direct_query(&sqc,"create or replace table t (bool0 bool null,bit1 bit null,tinyint2 tinyint null,smallint3 smallint null,int4 int null,bigint5 bigint null,real6 real null,float7 float null,date8 date null,datetime9 datetime null,varchar_10_10 varchar(10) null,varchar_100_11 varchar(100) null, nvarchar_20_12 nvarchar(20) null)");
-    new_query_execute(&sqc, "insert into t values (?,?,?,?,?,?,?,?,?,?,?,?,?)");
+    new_query_execute(&sqc, "insert into t (bool0,bit1,tinyint2,smallint3,int4,bigint5,real6,float7,date8,datetime9,varchar_10_10,varchar_100_11,\"nvarchar_20_12\") values (?,?,?,?,?,?,?,?,?,?,?,?,?)");
 
-    //Set using column name is still unsupported
-    REQUIRE_THROWS_AS(sqc.set_bool("bool0", rand_bool()), std::string);
-    REQUIRE_THROWS_AS(sqc.set_bool("bit1", rand_bool()), std::string);
-    REQUIRE_THROWS_AS(sqc.set_ubyte("tinyint2", rand_ubyte()), std::string);
-    REQUIRE_THROWS_AS(sqc.set_short("smallint3", rand_short()), std::string);
-    REQUIRE_THROWS_AS(sqc.set_int("int4", rand()), std::string);
-    REQUIRE_THROWS_AS(sqc.set_long("bigint5", rand_long()), std::string);
-    REQUIRE_THROWS_AS(sqc.set_float("real6", rand_float()), std::string);
-    REQUIRE_THROWS_AS(sqc.set_double("float7", rand_double()), std::string);
-    REQUIRE_THROWS_AS(sqc.set_date("date8", sqream::date(1991,2,21)), std::string);
-    REQUIRE_THROWS_AS(sqc.set_datetime("datetime9", sqream::datetime(1991,2,21,10,11,12,666)), std::string);
-    REQUIRE_THROWS_AS(sqc.set_varchar("varchar_10_10", rand_string(10)), std::string);
-    REQUIRE_THROWS_AS(sqc.set_varchar("varchar_100_11", rand_string(100)), std::string);
-    REQUIRE_THROWS_AS(sqc.set_nvarchar("nvarchar_20_12", rand_string(20)), std::string);
-    REQUIRE_THROWS_AS(sqc.set_null("bool0"), std::string);
+    REQUIRE_THROWS_AS(sqc.set_int("no_such_column", 0), std::string);
+    REQUIRE(sqc.get_column_index("nvarchar_20_12") == 12);
 
     int nrows = 500;
     unsigned int seed = rand();
     srand(seed);
     for (int r = 0; r < nrows; ++r) {
-        int i = 0;
-        sqc.set_bool(i++, rand_bool());
-        sqc.set_bool(i++, rand_bool());
-        sqc.set_ubyte(i++, rand_ubyte());
-        sqc.set_short(i++, rand_short());
-        sqc.set_int(i++, rand());
-        sqc.set_long(i++, rand_long());
-        sqc.set_float(i++, rand_float());
-        sqc.set_double(i++, rand_double());
-        sqc.set_date(i++, sqream::date(1991,2,21));
-        sqc.set_datetime(i++, sqream::datetime(1991,2,21,10,11,12,666));
-        sqc.set_varchar(i++, rand_string(10));
-        sqc.set_varchar(i++, rand_string(100));
-        sqc.set_nvarchar(i++, rand_string(20));
+        sqc.set_bool("bool0", rand_bool());
+        sqc.set_bool("bit1", rand_bool());
+        sqc.set_ubyte("tinyint2", rand_ubyte());
+        sqc.set_short("smallint3", rand_short());
+        sqc.set_int("int4", rand());
+        sqc.set_long("bigint5", rand_long());
+        sqc.set_float("real6", rand_float());
+        sqc.set_double("float7", rand_double());
+        sqc.set_date("date8", sqream::date(1991,2,21));
+        sqc.set_datetime("datetime9", sqream::datetime(1991,2,21,10,11,12,666));
+        sqc.set_varchar("varchar_10_10", rand_string(10));
+        sqc.set_varchar("varchar_100_11", rand_string(100));
+        sqc.set_nvarchar("nvarchar_20_12", rand_string(20));
         sqc.next_query_row();
 
-        i=0;
-        sqc.set_null(i++);
-        sqc.set_null(i++);
-        sqc.set_null(i++);
-        sqc.set_null(i++);
-        sqc.set_null(i++);
-        sqc.set_null(i++);
-        sqc.set_null(i++);
-        sqc.set_null(i++);
-        sqc.set_null(i++);
-        sqc.set_null(i++);
-        sqc.set_null(i++);
-        sqc.set_null(i++);
-        sqc.set_null(i++);
+        sqc.set_null("bool0");
+        sqc.set_null("bit1");
+        sqc.set_null("tinyint2");
+        sqc.set_null("smallint3");
+        sqc.set_null("int4");
+        sqc.set_null("bigint5");
+        sqc.set_null("real6");
+        sqc.set_null("float7");
+        sqc.set_null("date8");
+        sqc.set_null("datetime9");
+        sqc.set_null("varchar_10_10");
+        sqc.set_null("varchar_100_11");
+        sqc.set_null("nvarchar_20_12");
         sqc.next_query_row();
     }
     sqc.finish_query();